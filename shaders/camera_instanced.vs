@@ -0,0 +1,45 @@
+#version 130
+
+in highp vec3 vertexPos;
+in lowp vec3 vertexNormal;
+in lowp vec3 vertexTangent;
+in lowp vec3 vertexBitangent;
+in mediump vec2 vertexTexturePos;
+in mediump vec3 vertexColor;
+// the pose of the instance, the first 3 rows of its matrix
+in highp vec4 instanceRow0;
+in highp vec4 instanceRow1;
+in highp vec4 instanceRow2;
+
+// called model in diverse tutorials, moves all instances together
+uniform mat4 transformMesh2World;
+uniform mat4 transformWorld2camera;
+uniform mat4 projection;
+uniform mat4 lightSpaceMatrix;
+
+out vec3 VertexColor;
+out vec2 TexCoord;
+out vec3 FragPos;
+out vec3 FragNormal;
+out vec4 FragPosLightSpace;
+
+
+void main()
+{
+    mat4 instance = transpose(mat4(instanceRow0, instanceRow1, instanceRow2, vec4(0.0, 0.0, 0.0, 1.0)));
+    mat4 transform = transformMesh2World * instance;
+
+    // gl outs
+    vec4 FragPosWorld = transform * vec4(vertexPos, 1.0);
+    gl_Position = projection * transformWorld2camera * FragPosWorld;
+
+    // outs
+    mat3 rotation = mat3(transform);
+    FragNormal = normalize(rotation*vertexNormal);
+    VertexColor = vertexColor;
+    TexCoord = vertexTexturePos;
+    FragPos = vec3(FragPosWorld);
+
+    FragPosLightSpace = lightSpaceMatrix * FragPosWorld;
+}
+
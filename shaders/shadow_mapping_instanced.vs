@@ -0,0 +1,14 @@
+#version 130
+in highp vec3 vertexPos;
+in highp vec4 instanceRow0;
+in highp vec4 instanceRow1;
+in highp vec4 instanceRow2;
+
+uniform mat4 lightSpaceMatrix;
+uniform mat4 transformMesh2World;
+
+void main()
+{
+    mat4 instance = transpose(mat4(instanceRow0, instanceRow1, instanceRow2, vec4(0.0, 0.0, 0.0, 1.0)));
+    gl_Position = lightSpaceMatrix * transformMesh2World * instance * vec4(vertexPos, 1.0);
+}
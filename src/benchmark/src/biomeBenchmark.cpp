@@ -0,0 +1,46 @@
+#include <world/biome.h>
+#include <world/cellGrid.h>
+#include <world/weather.h>
+#include <world/world.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+// Measures how many cells per second biome::classify() classifies on a generated terrain.
+// usage: evosym_benchmark_biome [num_cells] [repetitions] [num_threads]
+int main(int argc, char* argv[]) {
+  const size_t num_cells = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+  const int repetitions = (argc > 2) ? std::atoi(argv[2]) : 20;
+  const unsigned int num_threads =
+      (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+  utils::TaskScheduler scheduler(num_threads);
+  CellGrid grid(num_cells);
+  World::generateTerrain(grid.getField(GROUND, HEIGHT), num_cells, 0, scheduler);
+  WeatherSolver().setEquilibriumTemperature(grid);
+  std::vector<uint8_t> biomes(num_cells);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repetitions; r++) {
+    biome::classify(grid, 0, scheduler, biomes.data());
+  }
+  const std::chrono::duration<double> passed = std::chrono::steady_clock::now() - start;
+
+  size_t counts[biome::NUM_BIOMES] = {};
+  for (const uint8_t b : biomes) {
+    counts[b]++;
+  }
+  printf("cells: %zu, threads: %u\n", num_cells, scheduler.getNumThreads());
+  printf("time: %.3f s, %.3e cells/s\n",
+         passed.count(),
+         static_cast<double>(num_cells) * repetitions / passed.count());
+  for (int b = 0; b < biome::NUM_BIOMES; b++) {
+    printf("%s: %.1f%%\n",
+           biome::getName(static_cast<uint8_t>(b)),
+           100. * static_cast<double>(counts[b]) / static_cast<double>(num_cells));
+  }
+  return 0;
+}
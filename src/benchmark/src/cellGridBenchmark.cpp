@@ -0,0 +1,37 @@
+#include <world/cellGrid.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Measures how many cells per second CellGrid::step() processes.
+// usage: evosym_benchmark_cell_grid [num_cells] [num_updates]
+int main(int argc, char* argv[]) {
+  const size_t num_cells = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const int num_updates = (argc > 2) ? std::atoi(argv[2]) : 100;
+
+  CellGrid grid(num_cells);
+  for (int l = 0; l < NUM_LAYER_TYPES; l++) {
+    const LayerTyp layer = static_cast<LayerTyp>(l);
+    for (int f = 0; f < NUM_GRID_FIELDS; f++) {
+      grid.fill(layer, static_cast<GridField>(f), 1e-3 * (f + 1));
+    }
+  }
+
+  // warm up caches and page in the memory
+  grid.step(1.);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_updates; i++) {
+    grid.step(1.);
+  }
+  const std::chrono::duration<double> passed = std::chrono::steady_clock::now() - start;
+
+  const double cells = static_cast<double>(num_cells) * num_updates;
+  printf("cells: %zu, layers: %d, updates: %d\n", num_cells, NUM_LAYER_TYPES, num_updates);
+  printf("time: %.3f s, %.3f ms/update\n", passed.count(), passed.count() * 1e3 / num_updates);
+  printf("%.3e cells/s\n", cells / passed.count());
+  // Print a value such that the loop can not be optimized away.
+  printf("checksum: %f\n", grid.getField(AIR, TEMPERATURE)[num_cells / 2]);
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include <world/creature.h>
+#include <world/plant.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/taskScheduler.hpp>
+
+// Measures how many creatures per second CreaturePopulation::update() simulates.
+// usage: evosym_benchmark_creatures [num_creatures] [num_updates] [num_threads]
+int main(int argc, char* argv[]) {
+  const size_t num_creatures = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const int num_updates = (argc > 2) ? std::atoi(argv[2]) : 100;
+  const unsigned int num_threads =
+      (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+  const size_t num_cells = 1 << 20;
+
+  utils::TaskScheduler scheduler(num_threads);
+  PlantPopulation plants;
+  plants.resize(num_cells);
+  CreaturePopulation creatures;
+  creatures.resize(num_cells, tool::PreciseTime());
+  creatures.spawn(num_creatures, 42, tool::PreciseTime());
+
+  const tool::PreciseTime dt =
+      std::chrono::duration_cast<tool::PreciseTime>(std::chrono::seconds(1));
+  tool::PreciseTime t = dt;
+  // warm up caches and page in the memory
+  creatures.update(t, scheduler, plants);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_updates; i++) {
+    t += dt;
+    creatures.update(t, scheduler, plants);
+  }
+  const std::chrono::duration<double> passed = std::chrono::steady_clock::now() - start;
+
+  printf("creatures: %zu, threads: %u, updates: %d\n",
+         num_creatures,
+         scheduler.getNumThreads(),
+         num_updates);
+  printf("time: %.3f s, %.3f ms/update\n", passed.count(), passed.count() * 1e3 / num_updates);
+  printf("%.3e creatures/s\n", static_cast<double>(num_creatures) * num_updates / passed.count());
+  printf("alive: %zu\n", creatures.size());
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include <world/cubedSphere.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void run(size_t face_size, size_t tile_size, int steps, utils::TaskScheduler& scheduler) {
+  const CubedSphere sphere(face_size, tile_size);
+  std::vector<double> values(sphere.getFieldSize(), 0.);
+  std::vector<double> result(sphere.getFieldSize(), 0.);
+  for (size_t t = 0; t < sphere.getNumTiles(); t++) {
+    size_t face, column, row;
+    sphere.getTileOrigin(t, face, column, row);
+    for (int r = 0; r < static_cast<int>(tile_size); r++) {
+      for (int c = 0; c < static_cast<int>(tile_size); c++) {
+        values[sphere.getIndex(t, c, r)] =
+            sphere.getCellCenter(face, static_cast<long>(column) + c, static_cast<long>(row) + r)
+                .z();
+      }
+    }
+  }
+
+  std::chrono::duration<double> halo(0.);
+  std::chrono::duration<double> stencil(0.);
+  for (int s = 0; s < steps; s++) {
+    const auto start = Clock::now();
+    sphere.exchangeHalos(values.data(), scheduler);
+    const auto exchanged = Clock::now();
+    sphere.smooth(values.data(), result.data(), 0.5, scheduler);
+    stencil += Clock::now() - exchanged;
+    halo += exchanged - start;
+    values.swap(result);
+  }
+  const double updates = static_cast<double>(sphere.getNumCells()) * steps;
+  printf("tile %4zu: %.3e cell updates/s, halo exchange %.1f%% of the time\n",
+         tile_size,
+         updates / (halo + stencil).count(),
+         100. * halo.count() / (halo + stencil).count());
+}
+}  // namespace
+
+// Measures a diffusion step on the tiles of a CubedSphere and the exchange of the ghost cells
+// for several tile sizes.
+// usage: evosym_benchmark_cubed_sphere [face_size] [steps] [num_threads]
+int main(int argc, char* argv[]) {
+  const size_t face_size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1024;
+  const int steps = (argc > 2) ? std::atoi(argv[2]) : 20;
+  const unsigned int num_threads =
+      (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+  utils::TaskScheduler scheduler(num_threads);
+  printf("face: %zu, cells: %zu, threads: %u\n",
+         face_size,
+         6 * face_size * face_size,
+         scheduler.getNumThreads());
+  for (const size_t tile_size : {16, 32, 64, 128, 256}) {
+    run(face_size, tile_size, steps, scheduler);
+  }
+  return 0;
+}
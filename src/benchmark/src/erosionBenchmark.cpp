@@ -0,0 +1,58 @@
+#include <world/erosion.h>
+#include <world/world.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <utils/taskScheduler.hpp>
+
+namespace {
+// mean absolute height difference between neighbouring cells of a row
+double getRoughness(const double* height, size_t num_cells) {
+  double sum = 0.;
+  for (size_t i = 1; i < num_cells; i++) {
+    sum += std::abs(height[i] - height[i - 1]);
+  }
+  return sum / static_cast<double>(num_cells - 1);
+}
+
+double getSum(const double* height, size_t num_cells) {
+  double sum = 0.;
+  for (size_t i = 0; i < num_cells; i++) {
+    sum += height[i];
+  }
+  return sum;
+}
+}  // namespace
+
+// Measures how many droplets per second erosion::erode() runs on a generated terrain.
+// usage: evosym_benchmark_erosion [num_cells] [num_droplets] [num_threads]
+int main(int argc, char* argv[]) {
+  const size_t num_cells = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+  const size_t num_droplets = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1 << 22;
+  const unsigned int num_threads =
+      (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+  utils::TaskScheduler scheduler(num_threads);
+  std::unique_ptr<double[]> height(new double[num_cells]);
+  World::generateTerrain(height.get(), num_cells, 0, scheduler);
+  const double roughness = getRoughness(height.get(), num_cells);
+  const double sum = getSum(height.get(), num_cells);
+
+  const erosion::Stats stats =
+      erosion::erode(height.get(), nullptr, num_cells, num_droplets, 1, scheduler);
+
+  printf("cells: %zu, droplets: %zu, threads: %u\n",
+         num_cells,
+         num_droplets,
+         scheduler.getNumThreads());
+  printf("time: %.3f s, %.3e droplets/s, %.1f steps/droplet\n",
+         stats.duration,
+         stats.getDropletsPerSecond(),
+         static_cast<double>(stats.num_steps) / static_cast<double>(num_droplets));
+  printf("roughness: %.1f m -> %.1f m\n", roughness, getRoughness(height.get(), num_cells));
+  printf("mean height change: %.3e m\n",
+         (getSum(height.get(), num_cells) - sum) / static_cast<double>(num_cells));
+  return 0;
+}
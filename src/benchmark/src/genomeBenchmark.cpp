@@ -0,0 +1,92 @@
+#include <world/genome.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+namespace {
+constexpr size_t WORDS = GenomeArena::GENOME_WORDS;
+
+template <class Operation>
+double measure(size_t num_ops, Operation operation) {
+  const auto start = std::chrono::steady_clock::now();
+  operation();
+  const std::chrono::duration<double> passed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_ops) / passed.count();
+}
+}  // namespace
+
+// Measures how many genome operations per second GenomeArena performs: mutate() and
+// crossover() on one thread, reproduce() (crossover + mutate + allocation) on all threads.
+// usage: evosym_benchmark_genomes [num_genomes] [num_rounds] [num_threads]
+int main(int argc, char* argv[]) {
+  const size_t num_genomes = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  const int num_rounds = (argc > 2) ? std::atoi(argv[2]) : 20;
+  const unsigned int num_threads =
+      (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+  utils::TaskScheduler scheduler(num_threads);
+  GenomeArena arena;
+  arena.reserve(2 * num_genomes);
+  std::vector<utils::Handle> genomes(num_genomes);
+  for (size_t i = 0; i < num_genomes; i++) {
+    genomes[i] = arena.addRandom(i);
+  }
+
+  const size_t num_ops = num_genomes * num_rounds;
+  std::vector<uint64_t> scratch(num_genomes * WORDS);
+  for (size_t i = 0; i < num_genomes; i++) {
+    const uint64_t* genome = arena.get(genomes[i]);
+    std::copy(genome, genome + WORDS, &scratch[i * WORDS]);
+  }
+  const double mutations = measure(num_ops, [&]() {
+    for (int r = 0; r < num_rounds; r++) {
+      for (size_t i = 0; i < num_genomes; i++) {
+        GenomeArena::mutate(&scratch[i * WORDS], r * num_genomes + i);
+      }
+    }
+  });
+  const double crossovers = measure(num_ops, [&]() {
+    for (int r = 0; r < num_rounds; r++) {
+      for (size_t i = 0; i + 1 < num_genomes; i++) {
+        uint64_t* genome = &scratch[i * WORDS];
+        GenomeArena::crossover(genome, genome + WORDS, genome, r * num_genomes + i);
+      }
+    }
+  });
+
+  // Every round all genomes get one child, then the parents die: a stable population.
+  std::vector<GenomeArena::Birth> births(num_genomes);
+  std::vector<utils::Handle> children;
+  const double reproductions = measure(num_ops, [&]() {
+    for (int r = 0; r < num_rounds; r++) {
+      for (size_t i = 0; i < num_genomes; i++) {
+        births[i] = {genomes[i], genomes[(i + 1) % num_genomes]};
+      }
+      arena.reproduce(births, children, scheduler, r);
+      for (size_t i = 0; i < num_genomes; i++) {
+        arena.remove(genomes[i]);
+      }
+      genomes.swap(children);
+    }
+  });
+
+  printf("genomes: %zu of %zu bits, threads: %u, rounds: %d\n",
+         num_genomes,
+         GenomeArena::GENOME_BITS,
+         scheduler.getNumThreads(),
+         num_rounds);
+  printf("mutate:    %.3e genomes/s (1 thread)\n", mutations);
+  printf("crossover: %.3e genomes/s (1 thread)\n", crossovers);
+  printf("reproduce: %.3e genomes/s\n", reproductions);
+  // keeps the single threaded loops from being optimized away
+  uint64_t checksum = 0;
+  for (uint64_t word : scratch) {
+    checksum ^= word;
+  }
+  printf("checksum: %016llx\n", static_cast<unsigned long long>(checksum));
+  return 0;
+}
@@ -0,0 +1,116 @@
+#include <world/geodesicGrid.h>
+#include <world/gridGeometry.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+namespace {
+
+template <class Step>
+double measure(int repetitions, const Step& step) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repetitions; r++) {
+    step();
+  }
+  const std::chrono::duration<double> passed = std::chrono::steady_clock::now() - start;
+  return passed.count();
+}
+
+// mean distance in memory from a cell to its neighbours
+double getMeanNeighbourDistance(const GeodesicGrid& grid) {
+  double sum = 0.;
+  for (size_t c = 0; c < grid.getNumCells(); c++) {
+    for (int k = 0; k < GeodesicGrid::MAX_NEIGHBOURS; k++) {
+      sum += std::abs(static_cast<double>(grid.getNeighbours(c)[k]) - static_cast<double>(c));
+    }
+  }
+  return sum / static_cast<double>(grid.getNumCells() * GeodesicGrid::MAX_NEIGHBOURS);
+}
+
+void runGeodesic(const char* name,
+                 GeodesicGrid::Ordering ordering,
+                 unsigned int level,
+                 int repetitions,
+                 utils::TaskScheduler& scheduler) {
+  const GeodesicGrid grid(level, ordering);
+  const size_t num_cells = grid.getNumCells();
+  std::vector<double> values(num_cells);
+  std::vector<double> result(num_cells);
+  for (size_t c = 0; c < num_cells; c++) {
+    values[c] = grid.getCellCenter(c).z();
+  }
+  const double seconds = measure(repetitions, [&]() {
+    grid.smooth(values.data(), result.data(), 0.5, scheduler);
+    values.swap(result);
+  });
+  printf("%-22s %.3e cell updates/s, mean neighbour distance %.0f cells\n",
+         name,
+         static_cast<double>(num_cells) * repetitions / seconds,
+         getMeanNeighbourDistance(grid));
+}
+
+// The same diffusion on the latitude rows of GridGeometry, the neighbours are computed from
+// the cell index as a simple kernel would.
+void runLatLong(size_t num_cells, int repetitions, utils::TaskScheduler& scheduler) {
+  const uint32_t cells = static_cast<uint32_t>(num_cells);
+  const size_t rows = GridGeometry::getNumRows(cells);
+  const size_t columns = GridGeometry::getNumColumns(cells);
+  const size_t used = rows * columns;
+  std::vector<double> values(used);
+  std::vector<double> result(used);
+  for (size_t c = 0; c < used; c++) {
+    values[c] = GridGeometry::getCellCenter(static_cast<uint32_t>(c), cells).z();
+  }
+  constexpr size_t CELLS_PER_TASK = 8192;
+  const size_t num_tasks = (used + CELLS_PER_TASK - 1) / CELLS_PER_TASK;
+  const double seconds = measure(repetitions, [&]() {
+    scheduler.parallelFor(num_tasks, [&](size_t task) {
+      const size_t end = std::min(used, (task + 1) * CELLS_PER_TASK);
+      for (size_t c = task * CELLS_PER_TASK; c < end; c++) {
+        const size_t row = c / columns;
+        const size_t column = c % columns;
+        const size_t first = row * columns;
+        const size_t left = first + (column + columns - 1) % columns;
+        const size_t right = first + (column + 1) % columns;
+        const size_t down = (row > 0) ? c - columns : c;
+        const size_t up = (row + 1 < rows) ? c + columns : c;
+        const double sum =
+            values[left] + values[right] + values[down] + values[up] - 4. * values[c];
+        result[c] = values[c] + 0.5 * 0.25 * sum;
+      }
+    });
+    values.swap(result);
+  });
+  printf("%-22s %.3e cell updates/s, %zu cells\n",
+         "lat/long rows",
+         static_cast<double>(used) * repetitions / seconds,
+         used);
+}
+}  // namespace
+
+// Measures the neighbour walk of a diffusion step on the GeodesicGrid, numbered along the
+// Hilbert curve and in icosphere order, against the latitude rows of GridGeometry.
+// usage: evosym_benchmark_geodesic_grid [level] [repetitions] [num_threads]
+int main(int argc, char* argv[]) {
+  const unsigned int level =
+      (argc > 1) ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 9;
+  const int repetitions = (argc > 2) ? std::atoi(argv[2]) : 20;
+  const unsigned int num_threads =
+      (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+  utils::TaskScheduler scheduler(num_threads);
+  printf("level: %u, cells: %zu, threads: %u\n",
+         level,
+         GeodesicGrid::getNumCells(level),
+         scheduler.getNumThreads());
+  runGeodesic(
+      "geodesic, hilbert", GeodesicGrid::HILBERT_ORDER, level, repetitions, scheduler);
+  runGeodesic(
+      "geodesic, icosphere", GeodesicGrid::ICOSPHERE_ORDER, level, repetitions, scheduler);
+  runLatLong(GeodesicGrid::getNumCells(level), repetitions, scheduler);
+  return 0;
+}
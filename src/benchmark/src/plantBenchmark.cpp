@@ -0,0 +1,43 @@
+#include <world/cellGrid.h>
+#include <world/plant.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/taskScheduler.hpp>
+
+// Measures how many plants per second PlantPopulation::update() simulates.
+// usage: evosym_benchmark_plants [num_plants] [num_updates] [num_threads]
+int main(int argc, char* argv[]) {
+  const size_t num_plants = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  const int num_updates = (argc > 2) ? std::atoi(argv[2]) : 100;
+  const unsigned int num_threads =
+      (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+  const size_t num_cells = num_plants / 8 + 1;
+
+  CellGrid grid(num_cells);
+  grid.fill(GROUND, TEMPERATURE, 293.15);
+  utils::TaskScheduler scheduler(num_threads);
+  PlantPopulation plants;
+  plants.resize(num_cells);
+  plants.sow(num_plants, 42);
+
+  // warm up caches and page in the memory
+  plants.update(1., grid, scheduler, 0);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= num_updates; i++) {
+    plants.update(1., grid, scheduler, static_cast<uint64_t>(i));
+  }
+  const std::chrono::duration<double> passed = std::chrono::steady_clock::now() - start;
+
+  printf("plants: %zu, cells: %zu, threads: %u, updates: %d\n",
+         num_plants,
+         num_cells,
+         scheduler.getNumThreads(),
+         num_updates);
+  printf("time: %.3f s, %.3f ms/update\n", passed.count(), passed.count() * 1e3 / num_updates);
+  printf("%.3e plants/s\n", static_cast<double>(num_plants) * num_updates / passed.count());
+  printf("alive: %zu\n", plants.size());
+  return 0;
+}
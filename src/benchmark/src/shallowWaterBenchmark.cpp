@@ -0,0 +1,58 @@
+#include <world/shallowWater.h>
+#include <world/world.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/taskScheduler.hpp>
+
+namespace {
+// [m] land with deeper water counts as lake or river
+constexpr double WET_DEPTH_M = 1.;
+
+double getSum(const double* values, size_t num_cells) {
+  double sum = 0.;
+  for (size_t i = 0; i < num_cells; i++) {
+    sum += values[i];
+  }
+  return sum;
+}
+}  // namespace
+
+// Measures the cell updates per second of erosion::ShallowWater on a generated terrain.
+// usage: evosym_benchmark_shallow_water [num_cells] [num_steps] [num_threads]
+int main(int argc, char* argv[]) {
+  const size_t num_cells = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+  const size_t num_steps = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1000;
+  const unsigned int num_threads =
+      (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+  utils::TaskScheduler scheduler(num_threads);
+  CellGrid grid(num_cells);
+  double* ground = grid.getField(GROUND, HEIGHT);
+  const double* water = grid.getField(WATER, HEIGHT);
+  World::generateTerrain(ground, num_cells, 0, scheduler);
+  const double ground_sum = getSum(ground, num_cells);
+
+  erosion::ShallowWater solver;
+  const erosion::Stats stats = solver.run(grid, nullptr, num_steps, scheduler);
+
+  // land covered by lakes and rivers
+  const double sea_level = solver.getParameters().sea_level;
+  size_t land = 0;
+  size_t wet = 0;
+  for (size_t i = 0; i < num_cells; i++) {
+    if (ground[i] >= sea_level) {
+      land++;
+      wet += (water[i] > WET_DEPTH_M) ? 1 : 0;
+    }
+  }
+
+  printf("cells: %zu, steps: %zu, threads: %u\n", num_cells, num_steps, scheduler.getNumThreads());
+  printf("time: %.3f s, %.3e cell updates/s\n", stats.duration, stats.getCellUpdatesPerSecond());
+  printf("land under water: %.2f %%\n",
+         100. * static_cast<double>(wet) / static_cast<double>(land));
+  printf("mean ground height change: %.3e m\n",
+         (getSum(ground, num_cells) - ground_sum) / static_cast<double>(num_cells));
+  return 0;
+}
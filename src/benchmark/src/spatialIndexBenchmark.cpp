@@ -0,0 +1,87 @@
+#include <world/spatialIndex.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/hash.hpp>
+#include <vector>
+
+namespace {
+Eigen::Vector3f randomPosition(uint64_t seed) {
+  Eigen::Vector3f p;
+  for (int a = 0; a < 3; a++) {
+    p[a] = 2.f * utils::toUnitFloat(utils::hash(seed * 3 + a)) - 1.f;
+  }
+  return p.normalized();
+}
+
+template <class Operation>
+double measure(size_t num_ops, Operation operation) {
+  const auto start = std::chrono::steady_clock::now();
+  operation();
+  const std::chrono::duration<double> passed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_ops) / passed.count();
+}
+}  // namespace
+
+// Measures SpatialIndex: builds and queries per second, the queries compared to a linear
+// scan over all points.
+// usage: evosym_benchmark_spatial_index [num_points] [num_queries] [k]
+int main(int argc, char* argv[]) {
+  const size_t num_points = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const size_t num_queries = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 100000;
+  const size_t k = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 8;
+  const float radius = 2e-3f;
+
+  std::vector<Eigen::Vector3f> points(num_points);
+  for (size_t i = 0; i < num_points; i++) {
+    points[i] = randomPosition(i);
+  }
+  std::vector<Eigen::Vector3f> queries(num_queries);
+  for (size_t i = 0; i < num_queries; i++) {
+    queries[i] = randomPosition(num_points + i);
+  }
+  const auto get_position = [&points](uint32_t i) { return points[i]; };
+
+  SpatialIndex index(radius);
+  const double builds = measure(num_points, [&]() { index.build(num_points, get_position); });
+
+  std::vector<SpatialIndex::Neighbor> result;
+  size_t num_found = 0;
+  const double radius_queries = measure(num_queries, [&]() {
+    for (const auto& query : queries) {
+      result.clear();
+      index.findInRadius(query, radius, result);
+      num_found += result.size();
+    }
+  });
+  const double nearest_queries = measure(num_queries, [&]() {
+    for (const auto& query : queries) {
+      index.findNearest(query, k, result);
+      num_found += result.size();
+    }
+  });
+
+  // A linear scan is slow, only a few queries.
+  const size_t num_scans = std::min<size_t>(num_queries, 100);
+  const float max_distance_squared = SpatialIndex::toDistanceSquared(radius);
+  const double scans = measure(num_scans, [&]() {
+    for (size_t q = 0; q < num_scans; q++) {
+      for (const auto& point : points) {
+        num_found += ((point - queries[q]).squaredNorm() <= max_distance_squared) ? 1 : 0;
+      }
+    }
+  });
+
+  printf("points: %zu, queries: %zu, radius: %.1e rad, k: %zu\n",
+         num_points,
+         num_queries,
+         radius,
+         k);
+  printf("build:         %.3e points/s\n", builds);
+  printf("radius query:  %.3e queries/s\n", radius_queries);
+  printf("nearest query: %.3e queries/s\n", nearest_queries);
+  printf("linear scan:   %.3e queries/s\n", scans);
+  printf("found: %zu\n", num_found);
+  return 0;
+}
@@ -0,0 +1,39 @@
+#include <world/world.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <utils/taskScheduler.hpp>
+
+// Measures how long World::generateTerrain() takes for a planet of num_cells cells.
+// usage: evosym_benchmark_terrain [num_cells] [num_threads] [seed]
+int main(int argc, char* argv[]) {
+  const size_t num_cells = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1 << 24;
+  const unsigned int num_threads =
+      (argc > 2) ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 0;
+  const uint64_t seed = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 0;
+
+  utils::TaskScheduler scheduler(num_threads);
+  std::unique_ptr<double[]> height(new double[num_cells]);
+
+  const auto start = std::chrono::steady_clock::now();
+  World::generateTerrain(height.get(), num_cells, seed, scheduler);
+  const std::chrono::duration<double> passed = std::chrono::steady_clock::now() - start;
+
+  double min = height[0];
+  double max = height[0];
+  double mean = 0.;
+  for (size_t i = 0; i < num_cells; i++) {
+    min = std::min(min, height[i]);
+    max = std::max(max, height[i]);
+    mean += height[i] / static_cast<double>(num_cells);
+  }
+  printf("cells: %zu, threads: %u, seed: %llu\n",
+         num_cells,
+         scheduler.getNumThreads(),
+         static_cast<unsigned long long>(seed));
+  printf("time: %.3f s, %.3e cells/s\n", passed.count(), num_cells / passed.count());
+  printf("height: min %.1f m, mean %.1f m, max %.1f m\n", min, mean, max);
+  return 0;
+}
@@ -0,0 +1,52 @@
+#include <world/weather.h>
+#include <world/world.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <utils/taskScheduler.hpp>
+
+// Measures the cell updates per second of the WeatherSolver on a generated terrain.
+// usage: evosym_benchmark_weather [num_cells] [days] [num_threads]
+int main(int argc, char* argv[]) {
+  const size_t num_cells = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+  const double days = (argc > 2) ? std::strtod(argv[2], nullptr) : 1.;
+  const unsigned int num_threads =
+      (argc > 3) ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 0;
+
+  utils::TaskScheduler scheduler(num_threads);
+  CellGrid grid(num_cells);
+  World::generateTerrain(grid.getField(GROUND, HEIGHT), num_cells, 0, scheduler);
+  grid.fill(AIR, TEMPERATURE, 288.15);
+  grid.fill(AIR, DENSITY, 1.225);
+
+  WeatherSolver solver;
+  solver.load(grid);
+  const WeatherStats stats = solver.simulate(days * 86400., scheduler);
+  solver.store(grid);
+
+  const double* temperature = grid.getField(AIR, TEMPERATURE);
+  const double* east = grid.getField(AIR, MASS_FLOW_GRADIENT_X);
+  const double* north = grid.getField(AIR, MASS_FLOW_GRADIENT_Y);
+  double max_wind = 0.;
+  for (size_t i = 0; i < num_cells; i++) {
+    max_wind = std::max(max_wind, std::hypot(east[i], north[i]));
+  }
+  const auto range = std::minmax_element(temperature, temperature + num_cells);
+
+  printf("cells: %zu, tiles: %zu, threads: %u\n",
+         num_cells,
+         solver.getNumTiles(),
+         scheduler.getNumThreads());
+  printf("%zu steps of %.1f s: %.3f s, %.3e cell updates/s\n",
+         stats.num_steps,
+         solver.getTimeStep(),
+         stats.duration,
+         stats.getCellUpdatesPerSecond());
+  printf("temperature: %.1f K to %.1f K, max wind: %.1f m/s\n",
+         *range.first,
+         *range.second,
+         max_wind);
+  return 0;
+}
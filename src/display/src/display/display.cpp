@@ -30,11 +30,17 @@ void Display::setCurrentFile(const std::string& file) {
 }
 
 bool Display::save() {
-  const bool is_simulating = simulationIsRunning();
-  if (is_simulating) {
-    stopSimulation();
+  if (simulationIsRunning()) {
+    // The simulation freezes a copy during its next tick, which is written in the background.
+    simulatedWorld.requestCheckpoint(current_world_file);
+    setStatus("Save " + current_world_file + " in the background");
+    return true;
   }
 
+  // A checkpoint of the simulation might still be written to the same file.
+  simulatedWorld.waitForCheckpoint();
+  reportCheckpoints();
+
   setStatus("Save " + current_world_file);
   const bool save_success = simulatedWorld.save(current_world_file);
   if (!save_success) {
@@ -43,12 +49,21 @@ bool Display::save() {
     popup_error(failed_msg);
     return false;
   }
-  if (is_simulating) {
-    startSimulation();
-  }
   return true;
 }
 
+void Display::reportCheckpoints() {
+  for (const CheckpointResult& result : simulatedWorld.takeCheckpointResults()) {
+    if (result.success) {
+      setStatus("Saved " + result.file);
+    } else {
+      const std::string failed_msg = "Failed to save " + result.file;
+      setStatus(failed_msg);
+      popup_error(failed_msg);
+    }
+  }
+}
+
 bool Display::saveAs(const std::string& file) {
   setStatus("Save As ...");
   setCurrentFile(file);
@@ -57,7 +72,13 @@ bool Display::saveAs(const std::string& file) {
 
 void Display::openFile(const std::string& file) {
   setStatus("Loading " + file + " ...");
-  WARNING("TODO");
+  stopSimulation();
+  if (!simulatedWorld.load(file)) {
+    const std::string failed_msg = "Failed to load " + file;
+    setStatus(failed_msg);
+    popup_error(failed_msg);
+    return;
+  }
   setCurrentFile(file);
 }
 
@@ -66,6 +87,9 @@ bool Display::startSimulation() {
     return false;
   }
   stop_simulation = false;
+  simulation_clock.setPeriod(simulationSettings.isBatchMode()
+                                 ? 0.
+                                 : simulationSettings.get_target_update_rate());
   simulation_thread = std::thread(&Display::runSimulation, this);
   setStatus("Run simulation ...");
   return true;
@@ -82,9 +106,7 @@ void Display::stopSimulation() {
 }
 
 void Display::runSimulation() {
-  while (!stop_simulation) {
-    simulatedWorld.update();
-  }
+  simulation_clock.run(stop_simulation, [this]() { simulatedWorld.update(); });
 }
 
 bool Display::exitGracefully() {
@@ -4,9 +4,11 @@
 #include <world/world.h>
 
 #include <array>
+#include <atomic>
 #include <settings.hpp>
 #include <string>
 #include <thread>
+#include <utils/fixedTimestep.hpp>
 
 #include "simulationSettings.h"
 
@@ -90,6 +92,12 @@ class Display : public util::Settings {
 
   bool hasUnsavedChanges() const { return need_save; }
 
+  /*!
+   * \brief Shows the outcome of the checkpoints written in the background since the last
+   * call. Call it regularly from the thread owning the window.
+   */
+  void reportCheckpoints();
+
   [[nodiscard]] bool exitGracefully();
 
   const std::array<int, 4>& getDisplayProportions() const {
@@ -117,6 +125,11 @@ class Display : public util::Settings {
     disp_pos_size[1] = y;
   }
 
+  /*!
+   * \brief Gives access to the simulated world, e.g. to read its snapshots for rendering.
+   */
+  World* getWorld() { return &simulatedWorld; }
+
   unsigned int getColorDepth() const { return color_depth; }
   void saveColorDepth(unsigned int color_depth) {
     this->color_depth = color_depth;
@@ -141,7 +154,9 @@ class Display : public util::Settings {
   // simulation
   void initSimulation();
   std::thread simulation_thread;
-  bool stop_simulation = false;
+  std::atomic<bool> stop_simulation{false};
+  // calls World::update() every target update period or back to back in batch mode
+  utils::FixedTimestep simulation_clock;
   bool need_save = false;
 
   // SETTINGS
@@ -8,6 +8,7 @@
 
 DisplayQt::DisplayQt() {
   open_gl_widget = new OpenGLWidget(this);
+  open_gl_widget->setWorld(getWorld());
   setCentralWidget(dynamic_cast<QWidget *>(open_gl_widget));
 
   QPoint qpos(getDisplayPosX(), getDisplayPosY());
@@ -20,6 +21,10 @@ DisplayQt::DisplayQt() {
   createToolBars();
   createStatusBar();
   setUnifiedTitleAndToolBarOnMac(true);
+
+  checkpoint_timer = new QTimer(this);
+  connect(checkpoint_timer, SIGNAL(timeout()), this, SLOT(reportCheckpoints()));
+  checkpoint_timer->start(CHECKPOINT_POLL_PERIOD_MS);
 }
 
 DisplayQt::~DisplayQt() {}
@@ -84,12 +89,14 @@ void DisplayQt::setStatus(const QString &msg, int timeout) {
 
 bool DisplayQt::save() { return Display::save(); }
 
+void DisplayQt::reportCheckpoints() { Display::reportCheckpoints(); }
+
 bool DisplayQt::saveAs() {
   QString file_name =
       QFileDialog::getSaveFileName(this,
                                    tr("Save current Simulation as"),
                                    tr(getCurrentFileName().c_str()),
-                                   tr("Address Book (*.abk);;All Files (*)"));
+                                   tr("EvoSym World (*.evsm);;All Files (*)"));
 
   return Display::saveAs(file_name.toStdString());
 }
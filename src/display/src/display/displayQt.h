@@ -3,6 +3,7 @@
 #define DISPLAY_QT
 
 #include <QMainWindow>
+#include <QTimer>
 
 #include "display.h"
 #include "openGLWidget.h"
@@ -39,6 +40,7 @@ class DisplayQt : public QMainWindow, public Display {
 
  private slots:
   bool save();
+  void reportCheckpoints();
   bool saveAs();
   void about() override;
   void newWorld();
@@ -54,6 +56,8 @@ class DisplayQt : public QMainWindow, public Display {
   // QT stuff
 
   OpenGLWidget *open_gl_widget;
+  // polls the checkpoints written in the background
+  QTimer *checkpoint_timer;
 
   QMenu *fileMenu;
   QMenu *editMenu;
@@ -66,6 +70,8 @@ class DisplayQt : public QMainWindow, public Display {
   QAction *saveAsAct;
   QAction *exitAct;
   QAction *aboutAct;
+
+  static constexpr int CHECKPOINT_POLL_PERIOD_MS = 500;
 };
 
 
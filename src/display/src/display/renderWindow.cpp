@@ -1,9 +1,12 @@
 #include "renderWindow.h"
 
 #include <SFML/OpenGL.hpp>
+#include <algorithm>
 #include <globals/globals.hpp>
 #include <randomGenerator.hpp>
 #include <utils/math.hpp>
+#include <world/gridGeometry.h>
+#include <world/world.h>
 
 
 RenderWindow::RenderWindow()
@@ -23,12 +26,16 @@ void RenderWindow::init() {
   sun_mesh = std::make_shared<SunMesh>();
   unsigned int wmiddtththx = addMesh(sun_mesh);
 
-  // init mesh
-  world_mesh = std::make_shared<WorldMesh>();
-  // set perspective for world mesh
+  // The planet, a sphere until the first snapshot brings the heights.
+  TerrainQuadtree::Settings terrain_settings;
+  terrain_settings.radius = PLANET_RADIUS;
+  terrain_mesh = std::make_shared<TerrainMesh>(
+      terrain_settings,
+      [](const Eigen::Vector3f&) { return 0.f; },
+      TERRAIN_MAX_HEIGHT_M * TERRAIN_EXAGGERATION * PLANET_RADIUS / PLANET_RADIUS_M);
   const Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
-  world_mesh->setTransformMesh2World(pose);
-  unsigned int wmid = addMesh(world_mesh);
+  terrain_mesh->setTransformMesh2World(pose);
+  unsigned int wmid = addMesh(terrain_mesh);
 
   double dir[6][3] = {
       {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
@@ -45,6 +52,8 @@ void RenderWindow::init() {
                        {5, -5, -5},
                        {-5, -5, -5}};
 
+  // one mesh, texture and shader for all copies, drawn in one call
+  world_mesh_copies = std::make_shared<WorldMeshInstances>();
   for (int r = 0; r < 3; r++) {
 
     for (int j = 0; j < 8; j++) {
@@ -53,16 +62,14 @@ void RenderWindow::init() {
         Eigen::Vector3d offset_local(pos[i]);
         Eigen::Vector3d offset_global(disp[j]);
         Eigen::Vector3d translation = offset_local * 1.2 + offset_global * 1.4;
-        std::shared_ptr<WorldMesh> world_meshx = std::make_shared<WorldMesh>();
-        world_meshx->setTransformMesh2World(
-            eigen_utils::getTransformation(translation, look_at));
-        unsigned int wmidx = addMesh(world_meshx);
+        world_mesh_copies->addInstance(eigen_utils::getTransformation(translation, look_at));
       }
     }
     for (int j = 0; j < 6; j++) {
       std::rotate(pos[j], pos[j] + 1, pos[j] + 3);
     }
   }
+  addMesh(world_mesh_copies);
 
   light_ptr->setShaddow(getDefualtFrameFuffer());
 }
@@ -110,8 +117,10 @@ void RenderWindow::enable3dDepth() {
 }
 
 void RenderWindow::update() {
-
-  animate();
+  updateInterpolation();
+  updateTerrainHeights();
+  animate(render_time);
+  terrain_mesh->update(window_size.y());
   // draw into shadow frame buffer
   glCheck(glBindFramebuffer(GL_FRAMEBUFFER, light_ptr->getDepthMapFrameBufferInt()));
 
@@ -156,19 +165,112 @@ bool RenderWindow::removeMesh(unsigned long id) {
 
 void RenderWindow::drawMesh() {
   QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+  const Frustum frustum(camera.getProjectionMatrix().matrix() * camera.getViewMatrix().matrix());
+  culling_stats.culled = 0;
   for (const auto& mesh : meshes) {
+    if (!mesh.second->isInside(frustum)) {
+      culling_stats.culled++;
+      continue;
+    }
     mesh.second->draw(gl);
   }
+  culling_stats.drawn = meshes.size() - culling_stats.culled;
+  reportCulling();
 }
 
 void RenderWindow::drawShadows() {
   QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+  // the shadow pass is rendered from the light
+  const Frustum frustum(light_ptr->getLightSpaceMatrix().matrix().cast<double>());
+  culling_stats.shadows_culled = 0;
   for (const auto& mesh : meshes) {
+    if (!mesh.second->isInside(frustum)) {
+      culling_stats.shadows_culled++;
+      continue;
+    }
     mesh.second->drawShadows(gl);
   }
+  culling_stats.shadows_drawn = meshes.size() - culling_stats.shadows_culled;
+}
+
+void RenderWindow::reportCulling() {
+  if (culling_stats.culled == reported_culling_stats.culled &&
+      culling_stats.shadows_culled == reported_culling_stats.shadows_culled) {
+    return;
+  }
+  F_DEBUG("Culled %zu of %zu meshes, %zu of %zu shadows.",
+          culling_stats.culled,
+          meshes.size(),
+          culling_stats.shadows_culled,
+          meshes.size());
+  reported_culling_stats = culling_stats;
 }
 
-void RenderWindow::animate() {
+void RenderWindow::updateInterpolation() {
+  const auto now = std::chrono::steady_clock::now();
+  if (world == nullptr) {
+    render_time = std::chrono::duration<double>(now - start_time).count();
+    return;
+  }
+  if (world->hasNewSnapshot()) {
+    if (world_snapshot != nullptr) {
+      // Still valid, readSnapshot() swaps it out.
+      previous_simulation_time = world_snapshot->simulation_time;
+      previous_wall_time = world_snapshot->wall_time;
+      has_previous_snapshot = true;
+    }
+    // Never blocks the simulation thread, returns the latest finished update.
+    world_snapshot = &world->readSnapshot();
+  }
+  if (world_snapshot == nullptr) {
+    return;
+  }
+  if (!has_previous_snapshot) {
+    interpolation = 1.;
+    render_time = world_snapshot->simulation_time;
+    return;
+  }
+
+  // Progress from the previous to the current snapshot as long as the simulation took
+  // from the previous to the current snapshot. Independent of the simulation rate and fps.
+  const double update_duration =
+      std::chrono::duration<double>(world_snapshot->wall_time - previous_wall_time).count();
+  const double since_update =
+      std::chrono::duration<double>(now - world_snapshot->wall_time).count();
+  interpolation = update_duration > 0. ? std::clamp(since_update / update_duration, 0., 1.) : 1.;
+  render_time = previous_simulation_time +
+                interpolation * (world_snapshot->simulation_time - previous_simulation_time);
+}
+
+void RenderWindow::updateTerrainHeights() {
+  if (world_snapshot == nullptr || world_snapshot->height[GROUND].empty()) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  if (has_terrain_heights && now - terrain_time < TERRAIN_REFRESH_PERIOD) {
+    return;
+  }
+  terrain_time = now;
+  has_terrain_heights = true;
+
+  // shared by the sampler, the snapshot is overwritten by the next update
+  const auto ground =
+      std::make_shared<const std::vector<float>>(world_snapshot->height[GROUND]);
+  const uint32_t num_cells = static_cast<uint32_t>(ground->size());
+  constexpr float scale = TERRAIN_EXAGGERATION * PLANET_RADIUS / PLANET_RADIUS_M;
+  // The cells are steps, refining further would only sharpen them.
+  const unsigned int max_level = TerrainQuadtree::getMaxLevel(
+      num_cells, terrain_mesh->getQuadtree().getSettings().patch_size);
+  terrain_mesh->setHeights(
+      [ground, num_cells, scale](const Eigen::Vector3f& direction) {
+        return scale * (*ground)[GridGeometry::getCell(
+                           direction.x(), direction.y(), direction.z(), num_cells)];
+      },
+      TERRAIN_MAX_HEIGHT_M * scale,
+      max_level);
+}
+
+void RenderWindow::animate(double time) {
   /*
    // todo this is part of simulation
    static Eigen::Vector3f nextPos = light.getPosition();
@@ -205,21 +307,15 @@ void RenderWindow::animate() {
    */
 
 
-  const float r = 105;
-  static float phi = 0.;
-  phi += 0.003;
-  static float theta = 0.;
-  theta += 0.003;
-  static float y_dir = 1.;
-
-  static float y = 0;
-  y += 0.04f * y_dir;
-  if (std::abs(y) > 100) {
-    y_dir *= -1;
-  }
-
-  const float z = std::sin(phi) * r;
-  const float x = std::cos(theta) * r;
+  const double angle = SUN_ANGULAR_SPEED * time;
+  // Up and down between -SUN_MAX_HEIGHT and SUN_MAX_HEIGHT, starting at 0 upwards.
+  const double phase =
+      std::fmod(SUN_VERTICAL_SPEED * time + SUN_MAX_HEIGHT, 4. * SUN_MAX_HEIGHT);
+  const float y = static_cast<float>(phase < 2. * SUN_MAX_HEIGHT
+                                         ? phase - SUN_MAX_HEIGHT
+                                         : 3. * SUN_MAX_HEIGHT - phase);
+  const float z = static_cast<float>(std::sin(angle) * SUN_DISTANCE);
+  const float x = static_cast<float>(std::cos(angle) * SUN_DISTANCE);
 
   const Eigen::Vector3f light_pos(x, y, z);
   light_ptr->setPositionAndTarget(light_pos, Eigen::Vector3f(0, 0, 0));
@@ -3,17 +3,21 @@
 
 
 #include <display_elements/sun.h>
+#include <display_elements/terrainMesh.h>
 #include <display_elements/worldMesh.h>
 
 #include <chrono>
 #include <cmath>
 #include <display_elements/camera.hpp>
 #include <display_elements/displayUtils.hpp>
+#include <display_elements/frustum.hpp>
 #include <display_elements/light.hpp>
 #include <display_elements/mesh.hpp>
 #include <functional>
 #include <timer/timer.hpp>
+#include <world/worldSnapshot.h>
 
+class World;
 
 struct IsPressed {
   bool ctrl = false;
@@ -29,6 +33,15 @@ struct IsPressed {
 
 class RenderWindow : protected QOpenGLExtraFunctions {
  public:
+  // The meshes drawn and skipped in a frame since they are outside of the frustum.
+  struct CullingStats {
+    size_t drawn = 0;
+    size_t culled = 0;
+    // in the shadow pass, against the frustum of the light
+    size_t shadows_drawn = 0;
+    size_t shadows_culled = 0;
+  };
+
   RenderWindow();
 
   void init();
@@ -51,6 +64,15 @@ class RenderWindow : protected QOpenGLExtraFunctions {
     getDefualtFrameFuffer = func;
   }
 
+  /*!
+   * \brief Sets the world whose snapshots are read each frame.
+   * \param world The simulated world, RenderWindow is its only snapshot reader.
+   */
+  void setWorld(World *world) { this->world = world; }
+
+  // Of the last frame.
+  const CullingStats &getCullingStats() const { return culling_stats; }
+
  protected:
   void dragMouseLeft(const Eigen::Vector2i &diff);
   void dragMouseRight(const Eigen::Vector2i &diff);
@@ -77,9 +99,29 @@ class RenderWindow : protected QOpenGLExtraFunctions {
   void drawMesh();
   void drawShadows();
 
+  /*!
+   * \brief Prints the culling stats of the frame if they differ from the last printed ones.
+   */
+  void reportCulling();
+
   void printGraphicCardInformation();
 
-  void animate();
+  /*!
+   * \brief Moves the sun along its path.
+   * \param time [s] The point in time to show, positions are a function of it.
+   */
+  void animate(double time);
+
+  /*!
+   * \brief Takes the newest snapshot (if any) and updates interpolation and render_time.
+   */
+  void updateInterpolation();
+
+  /*!
+   * \brief Hands the ground heights of the current snapshot to the terrain, at most every
+   * TERRAIN_REFRESH_PERIOD since the terrain rebuilds its patches for new heights.
+   */
+  void updateTerrainHeights();
 
   Camera camera;
   Eigen::Vector2i last_mouse_pos = Eigen::Vector2i(0, 0);
@@ -91,13 +133,49 @@ class RenderWindow : protected QOpenGLExtraFunctions {
 
   std::map<unsigned long, const std::shared_ptr<BaseMesh>> meshes;
   unsigned long mesh_counter = 0;
+  CullingStats culling_stats;
+  CullingStats reported_culling_stats;
 
-  std::shared_ptr<WorldMesh> world_mesh = nullptr;
+  std::shared_ptr<TerrainMesh> terrain_mesh = nullptr;
+  std::shared_ptr<WorldMeshInstances> world_mesh_copies = nullptr;
   std::shared_ptr<SunMesh> sun_mesh = nullptr;
   std::shared_ptr<Light> light_ptr;
 
   bool is_initialized = false;
 
+  World *world = nullptr;
+  // Consistent state of the world for this frame, valid until the next update()
+  const WorldSnapshot *world_snapshot = nullptr;
+  // Of the snapshot before world_snapshot, only its times are needed to interpolate.
+  double previous_simulation_time = 0.;
+  std::chrono::steady_clock::time_point previous_wall_time;
+  bool has_previous_snapshot = false;
+  // Blend factor between the previous snapshot (0) and world_snapshot (1) for this frame.
+  // The renderer lags one update behind the simulation to always have two states.
+  double interpolation = 1.;
+  // [s] The simulated time shown in this frame. Without a world the wall time is used.
+  double render_time = 0.;
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+  // when the terrain got the heights of a snapshot, the first one is taken at once
+  std::chrono::steady_clock::time_point terrain_time;
+  bool has_terrain_heights = false;
+
+  // sun path, per simulated second
+  static constexpr double SUN_DISTANCE = 105.;
+  static constexpr double SUN_ANGULAR_SPEED = 0.0072;
+  static constexpr double SUN_MAX_HEIGHT = 100.;
+  static constexpr double SUN_VERTICAL_SPEED = 0.096;
+
+  // [mesh units] the planet at sea level
+  static constexpr float PLANET_RADIUS = 0.6f;
+  // [m] as WeatherParameters::planet_radius
+  static constexpr float PLANET_RADIUS_M = 6.371e6f;
+  // heights are shown that much higher than to scale
+  static constexpr float TERRAIN_EXAGGERATION = 20.f;
+  // [m] the height colored as the highest peaks
+  static constexpr float TERRAIN_MAX_HEIGHT_M = 6000.f;
+  static constexpr std::chrono::seconds TERRAIN_REFRESH_PERIOD{10};
+
   CallbackGetDefaultFrameBuffer getDefualtFrameFuffer = []() { return 0; };
 };
 
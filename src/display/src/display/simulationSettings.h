@@ -16,18 +16,28 @@ class SimulationSettings : public util::Settings {
       : Settings(Globals::getInstance().getPath2SimulationSettings()) {
     put<int>(target_fps, FPS_ID);
     put<int>(text_size, TEXT_SIZE_ID);
+    put<bool>(batch_mode, BATCH_MODE_ID);
   }
 
   double get_target_update_rate() {
     return 1. / static_cast<double>(target_fps);
   }
 
+  /*!
+   * \brief If true the world is updated as fast as possible instead of target_fps times
+   * per second.
+   */
+  bool isBatchMode() const { return batch_mode; }
+
  private:
   int target_fps = 25;
   const std::string FPS_ID = "target_fps";
 
   int text_size = 25;
   const std::string TEXT_SIZE_ID = "text_size";
+
+  bool batch_mode = false;
+  const std::string BATCH_MODE_ID = "batch_mode";
 };
 
 #endif
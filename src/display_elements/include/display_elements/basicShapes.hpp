@@ -7,6 +7,7 @@
 #include <Eigen/StdVector>
 #include <display_elements/vertex.hpp>
 #include <utils/eigen_conversations.hpp>
+#include <utils/icosphere.hpp>
 #include <utils/math.hpp>
 
 using namespace Eigen;
@@ -352,6 +353,131 @@ inline void getRectangleInformation(unsigned int &num_vertices,
   num_vertices = resolution + 1;
 }
 
+// How a corner of an icosphere triangle gets its texture coordinates, see getIcosphereCorners().
+enum class IcosphereCorner { SHARED, SEAM, POLE };
+
+// The texture coordinates of the corners of an icosphere triangle. The longitude wraps from 1 to
+// 0 on the seam, so in triangles across it the corners with u < 0.5 get u + 1 (SEAM). At the
+// poles the longitude is undefined and the corner takes the mean u of the other two (POLE).
+inline std::array<IcosphereCorner, 3> getIcosphereCorners(
+    const utils::IcosphereLevel &sphere,
+    const std::array<uint32_t, 3> &triangle,
+    std::array<std::array<float, 2>, 3> &corners) {
+  std::array<IcosphereCorner, 3> kinds;
+  float u_min = 1.f;
+  float u_max = 0.f;
+  for (int k = 0; k < 3; k++) {
+    const Vector3f &position = sphere.positions[triangle[k]];
+    corners[k] = sphere.texture_coordinates[triangle[k]];
+    if (std::abs(position.x()) + std::abs(position.y()) < 1e-6f) {
+      kinds[k] = IcosphereCorner::POLE;
+    } else {
+      kinds[k] = IcosphereCorner::SHARED;
+      u_min = std::min(u_min, corners[k][0]);
+      u_max = std::max(u_max, corners[k][0]);
+    }
+  }
+
+  if (u_max - u_min > 0.5f) {
+    for (int k = 0; k < 3; k++) {
+      if (kinds[k] == IcosphereCorner::SHARED && corners[k][0] < 0.5f) {
+        corners[k][0] += 1.f;
+        kinds[k] = IcosphereCorner::SEAM;
+      }
+    }
+  }
+  for (int k = 0; k < 3; k++) {
+    if (kinds[k] == IcosphereCorner::POLE) {
+      corners[k][0] = 0.5f * (corners[(k + 1) % 3][0] + corners[(k + 2) % 3][0]);
+    }
+  }
+  return kinds;
+}
+
+// Sphere around (0,0,0) made of equally sized triangles which share their vertices.
+// Every level has 4 times the triangles, the unit sphere of each level is cached (see
+// utils::IcosphereLevel), thus regenerating a level only scales and copies.
+// Texture coordinates are longitude and latitude. With textures the vertices on the seam are
+// duplicated and every triangle gets its own pole vertices, see getIcosphereCorners().
+template <class VertexType>
+inline void icosphere(std::vector<VertexType> &vertices,
+                      IndicesVector &indices_vector,
+                      float radius,
+                      unsigned int level,
+                      const Matrix<float, VertexType::NUM_COLOR, 1> color =
+                          Matrix<float, VertexType::NUM_COLOR, 1>::Zero()) {
+  const utils::IcosphereLevel &sphere = utils::IcosphereLevel::get(level);
+  const unsigned int first_index = vertices.size();
+
+  vertices.reserve(vertices.size() + sphere.positions.size());
+  for (size_t i = 0; i < sphere.positions.size(); i++) {
+    pushVertexTypeBack(vertices, radius * sphere.positions[i], sphere.positions[i], color);
+    if constexpr (VertexType::HAS_TEXTURE) {
+      vertices.back().texture_pos[0] = sphere.texture_coordinates[i][0];
+      vertices.back().texture_pos[1] = sphere.texture_coordinates[i][1];
+    }
+  }
+
+  // per vertex: its copy with u + 1, 0 while there is none
+  std::vector<unsigned int> seam_copies;
+  if constexpr (VertexType::HAS_TEXTURE) {
+    seam_copies.resize(sphere.positions.size(), 0);
+  }
+
+  indices_vector.reserve(indices_vector.size() + 3 * sphere.triangles.size());
+  for (const auto &triangle : sphere.triangles) {
+    std::array<unsigned int, 3> indices = {
+        first_index + triangle[0], first_index + triangle[1], first_index + triangle[2]};
+    if constexpr (VertexType::HAS_TEXTURE) {
+      std::array<std::array<float, 2>, 3> corners;
+      const std::array<IcosphereCorner, 3> kinds = getIcosphereCorners(sphere, triangle, corners);
+      for (int k = 0; k < 3; k++) {
+        if (kinds[k] == IcosphereCorner::SHARED) {
+          continue;
+        }
+        unsigned int &copy = seam_copies[triangle[k]];
+        if (kinds[k] == IcosphereCorner::POLE || copy == 0) {
+          const Vector3f &position = sphere.positions[triangle[k]];
+          pushVertexTypeBack(vertices, radius * position, position, color);
+          vertices.back().texture_pos[0] = corners[k][0];
+          vertices.back().texture_pos[1] = corners[k][1];
+          indices[k] = vertices.size() - 1;
+          if (kinds[k] == IcosphereCorner::SEAM) {
+            copy = indices[k];
+          }
+        } else {
+          indices[k] = copy;
+        }
+      }
+    }
+    indices_vector.insert(indices_vector.end(), indices.begin(), indices.end());
+  }
+}
+
+// The size of icosphere() with texture coordinates, including the duplicated seam and pole
+// vertices.
+inline void getIcosphereInformation(unsigned int &num_vertices,
+                                    unsigned int &num_triangles,
+                                    unsigned int level) {
+  const utils::IcosphereLevel &sphere = utils::IcosphereLevel::get(level);
+  std::vector<bool> on_seam(sphere.positions.size(), false);
+  num_vertices = sphere.positions.size();
+  num_triangles = sphere.triangles.size();
+  for (const auto &triangle : sphere.triangles) {
+    std::array<std::array<float, 2>, 3> corners;
+    const std::array<IcosphereCorner, 3> kinds = getIcosphereCorners(sphere, triangle, corners);
+    for (int k = 0; k < 3; k++) {
+      if (kinds[k] == IcosphereCorner::POLE ||
+          (kinds[k] == IcosphereCorner::SEAM && !on_seam[triangle[k]])) {
+        num_vertices++;
+      }
+      if (kinds[k] == IcosphereCorner::SEAM) {
+        on_seam[triangle[k]] = true;
+      }
+    }
+  }
+}
+
 }  // namespace basicShape
 
 #endif
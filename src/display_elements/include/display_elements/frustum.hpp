@@ -0,0 +1,70 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <Eigen/Geometry>
+#include <array>
+#include <utils/minmax.hpp>
+
+/*!
+ * \brief The 6 planes bounding what a projection shows, perspective or orthogonal, taken from
+ * the rows of the clip matrix (Gribb, Hartmann: Fast Extraction of Viewing Frustum Planes from
+ * the World-View-Projection Matrix, 2001). The tests are conservative: a volume which is not
+ * outside may still be invisible, e.g. near the corners of the frustum.
+ */
+class Frustum {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /*!
+   * \param clip_from_frame Transforms from the frame to test in to clip space, e.g.
+   * projection * view for world coordinates or projection * view * mesh2world for mesh
+   * coordinates.
+   */
+  explicit Frustum(const Eigen::Matrix4d& clip_from_frame) {
+    const Eigen::Matrix4d& m = clip_from_frame;
+    // left, right, bottom, top, near, far: -w <= x, y, z <= w
+    for (int axis = 0; axis < 3; axis++) {
+      planes[2 * axis] = (m.row(3) + m.row(axis)).transpose();
+      planes[2 * axis + 1] = (m.row(3) - m.row(axis)).transpose();
+    }
+    for (Eigen::Vector4d& plane : planes) {
+      plane /= plane.head<3>().norm();
+    }
+  }
+
+  /*!
+   * \brief True if the sphere is completely outside of the frustum.
+   */
+  bool isOutside(const Eigen::Vector3d& center, double radius) const {
+    for (const Eigen::Vector4d& plane : planes) {
+      if (plane.head<3>().dot(center) + plane.w() < -radius) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*!
+   * \brief True if the box is completely outside of the frustum: its corner furthest along
+   * the normal of a plane is behind it.
+   */
+  bool isOutside(const utils::MinMax3d<double>& box) const {
+    const Eigen::Vector3d min = box.min();
+    const Eigen::Vector3d max = box.max();
+    for (const Eigen::Vector4d& plane : planes) {
+      const Eigen::Vector3d furthest((plane.x() > 0.) ? max.x() : min.x(),
+                                     (plane.y() > 0.) ? max.y() : min.y(),
+                                     (plane.z() > 0.) ? max.z() : min.z());
+      if (plane.head<3>().dot(furthest) + plane.w() < 0.) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  // inside: normal.dot(point) + w >= 0, with normalized normals
+  std::array<Eigen::Vector4d, 6> planes;
+};
+
+#endif
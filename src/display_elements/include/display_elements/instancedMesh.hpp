@@ -0,0 +1,280 @@
+#ifndef INSTANCED_MESH_HPP
+#define INSTANCED_MESH_HPP
+
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <algorithm>
+#include <display_elements/mesh.hpp>
+#include <globals/globals.hpp>
+#include <limits>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Many copies of one mesh drawn with a single glDrawElementsInstanced() call. The
+ * geometry, texture and shaders exist once and are shared by all instances, which only differ
+ * in their pose. The poses are streamed through an instance buffer, the first 3 rows of each
+ * pose are per instance vertex attributes (instanceRow0, 1, 2 in camera_instanced.vs and
+ * shadow_mapping_instanced.vs). The buffer is only uploaded in a frame in which poses changed.
+ * The pose of the mesh itself (setTransformMesh2World()) moves all instances together.
+ * The bounding box contains all instances, setInstance() only grows it, setInstances() fits it
+ * anew.
+ */
+template <bool has_position = true, bool has_normal = true, bool has_tangent = true, bool has_bitangent = true, bool has_texture = true, bool has_color = true, int num_color_values = 3>
+class InstancedMesh
+    : public Mesh<has_position, has_normal, has_tangent, has_bitangent, has_texture, has_color, num_color_values> {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  using Base =
+      Mesh<has_position, has_normal, has_tangent, has_bitangent, has_texture, has_color, num_color_values>;
+  using VertexType = typename Base::VertexType;
+  // The first 3 rows of the transformation from the mesh to the instance, as uploaded.
+  using InstancePose = Eigen::Matrix<float, 3, 4, Eigen::RowMajor>;
+  using InstancePoses = std::vector<InstancePose, Eigen::aligned_allocator<InstancePose>>;
+
+  InstancedMesh() : Base() {}
+
+  ~InstancedMesh() {
+    QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+    glCheck(gl->glDeleteBuffers(1, &instance_VBO));
+  }
+
+  /*!
+   * \brief Reserves space on GPU for the texture, the vertices and the instances.
+   * \param vertices The vector of vertices describeing the mesh and what not.
+   * \param indices A vector of indices describeing the order of the vertices.
+   * \param texture_path The path to the texture.
+   */
+  void init(const std::vector<VertexType>& vertices,
+            const std::vector<unsigned int>& indices,
+            const std::string& texture_path) {
+    Base::init(vertices, indices, texture_path);
+    initInstances();
+  }
+
+  void init(const std::vector<VertexType>& vertices, const std::vector<unsigned int>& indices) {
+    Base::init(vertices, indices);
+    initInstances();
+  }
+
+  /*!
+   * \brief Loads the instanced shaders for the camera and the shadows. Call after init().
+   */
+  void loadInstancedShaders() {
+    const std::string path = Globals::getInstance().getAbsPath2Shaders();
+    BaseMesh::loadShader(path + "camera_instanced.vs", path + "camera.fs");
+    BaseMesh::addShaddow(path + "shadow_mapping_instanced.vs", path + "shadow_mapping.fs");
+  }
+
+  /*!
+   * \brief Adds an instance.
+   * \param pose From the mesh to the instance, may scale.
+   * \return The index of the instance.
+   */
+  size_t addInstance(const Eigen::Affine3d& pose) {
+    instances.push_back(pose.matrix().template topRows<3>().template cast<float>());
+    growBounds(instances.back());
+    has_changed = true;
+    return instances.size() - 1;
+  }
+
+  void setInstance(size_t index, const Eigen::Affine3d& pose) {
+    instances[index] = pose.matrix().template topRows<3>().template cast<float>();
+    growBounds(instances[index]);
+    has_changed = true;
+  }
+
+  /*!
+   * \brief Replaces all instances, e.g. all plants of a species each frame.
+   */
+  void setInstances(const InstancePoses& poses) {
+    instances = poses;
+    fitBounds();
+    has_changed = true;
+  }
+
+  void clearInstances() {
+    instances.clear();
+    fitBounds();
+    has_changed = true;
+  }
+
+  size_t getNumInstances() const { return instances.size(); }
+
+  const InstancePoses& getInstances() const { return instances; }
+
+  void draw(QOpenGLExtraFunctions* gl) override {
+    if (this->shader_camera == nullptr || instances.empty()) {
+      return;
+    }
+    uploadInstances(gl);
+
+    glCheck(this->shader_camera->use());
+
+    if constexpr (has_texture) {
+      glCheck(gl->glActiveTexture(GL_TEXTURE0 +
+                                  BaseMesh::SHADER_UNIFORM_CAMERA_OBJECT_TEXTURE_ID));
+      glCheck(gl->glBindTexture(GL_TEXTURE_2D, this->texture));
+    }
+
+    if (this->light && this->light->hasShadow()) {
+      glCheck(gl->glActiveTexture(GL_TEXTURE0 +
+                                  BaseMesh::SHADER_UNIFORM_CAMERA_SHADOW_TEXTURE_ID));
+      glCheck(gl->glBindTexture(GL_TEXTURE_2D, this->light->getDepthMapTexture()));
+    }
+
+    drawInstances(gl);
+
+    glCheck(gl->glActiveTexture(GL_TEXTURE0));
+    glCheck(gl->glBindTexture(GL_TEXTURE_2D, 0));
+    glCheck(gl->glActiveTexture(GL_TEXTURE1));
+    glCheck(gl->glBindTexture(GL_TEXTURE_2D, 0));
+
+    glCheck(this->shader_camera->release());
+
+    if (this->debug_normals && this->normals) {
+      this->normals->draw(gl);
+    }
+  }
+
+  void drawShadows(QOpenGLExtraFunctions* gl) override {
+    if (this->light == nullptr || !this->light->hasShadow() || this->shader_shadow == nullptr ||
+        instances.empty()) {
+      return;
+    }
+    uploadInstances(gl);
+    glCheck(this->shader_shadow->use());
+    drawInstances(gl);
+    this->shader_shadow->release();
+  }
+
+ protected:
+  void connectShader(unsigned int shaderProgram) override {
+    Base::connectShader(shaderProgram);
+    connectInstances(shaderProgram);
+  }
+
+  void connectShadowShader(unsigned int shaderProgram) override {
+    Base::connectShadowShader(shaderProgram);
+    connectInstances(shaderProgram);
+  }
+
+ private:
+  void initInstances() {
+    QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+    if (instance_VBO == 0) {
+      glCheck(gl->glGenBuffers(1, &instance_VBO));
+    }
+    // the instances are placed around this box
+    geometry_center = this->bounding_box_mesh.center();
+    geometry_radius =
+        0.5 * (this->bounding_box_mesh.max() - this->bounding_box_mesh.min()).norm();
+    fitBounds();
+    // connectShader() expects the vertices to be bound
+    glCheck(gl->glBindBuffer(GL_ARRAY_BUFFER, this->VBO));
+  }
+
+  /*!
+   * \brief Points the instance attributes of a shader into the instance buffer, advancing
+   * once per instance.
+   */
+  void connectInstances(unsigned int shaderProgram) {
+    QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+    glCheck(gl->glBindVertexArray(this->VAO));
+    glCheck(gl->glBindBuffer(GL_ARRAY_BUFFER, instance_VBO));
+    for (int row = 0; row < 3; row++) {
+      const std::string name = SHADER_IN_INSTANCE_ROW_NAME + std::to_string(row);
+      const int location = gl->glGetAttribLocation(shaderProgram, name.c_str());
+      glCheckAfter();
+      if (location < 0) {
+        F_WARNING("Trying to connect to shader variable %s failed. Variable not found",
+                  name.c_str());
+        continue;
+      }
+      const unsigned int u_location = static_cast<unsigned int>(location);
+      glCheck(gl->glEnableVertexAttribArray(u_location));
+      glCheck(gl->glVertexAttribPointer(u_location,
+                                        4,
+                                        GL_FLOAT,
+                                        GL_FALSE,
+                                        sizeof(InstancePose),
+                                        reinterpret_cast<void*>(row * 4 * sizeof(float))));
+      glCheck(gl->glVertexAttribDivisor(u_location, 1));
+    }
+    glCheck(gl->glBindVertexArray(0));
+    // the next shader connects its vertex attributes
+    glCheck(gl->glBindBuffer(GL_ARRAY_BUFFER, this->VBO));
+  }
+
+  void uploadInstances(QOpenGLExtraFunctions* gl) {
+    if (!has_changed) {
+      return;
+    }
+    glCheck(gl->glBindBuffer(GL_ARRAY_BUFFER, instance_VBO));
+    // a new buffer each time, the driver needs not wait for draws still reading the old one
+    glCheck(gl->glBufferData(GL_ARRAY_BUFFER,
+                             instances.size() * sizeof(InstancePose),
+                             instances.data(),
+                             GL_STREAM_DRAW));
+    glCheck(gl->glBindBuffer(GL_ARRAY_BUFFER, 0));
+    has_changed = false;
+  }
+
+  void drawInstances(QOpenGLExtraFunctions* gl) {
+    glCheck(gl->glBindVertexArray(this->VAO));
+    glCheck(gl->glDrawElementsInstanced(GL_TRIANGLES,
+                                        static_cast<GLsizei>(this->indices.size()),
+                                        GL_UNSIGNED_INT,
+                                        nullptr,
+                                        static_cast<GLsizei>(instances.size())));
+    glCheck(gl->glBindVertexArray(0));
+  }
+
+  /*!
+   * \brief Extends min and max by the sphere around an instance.
+   */
+  void addToBounds(const InstancePose& pose, Eigen::Vector3d& min, Eigen::Vector3d& max) const {
+    const Eigen::Matrix3d linear = pose.template leftCols<3>().template cast<double>();
+    const Eigen::Vector3d center =
+        linear * geometry_center + pose.col(3).template cast<double>();
+    // the largest scale of the instance
+    const double radius = geometry_radius * linear.colwise().norm().maxCoeff();
+    min = min.cwiseMin((center.array() - radius).matrix());
+    max = max.cwiseMax((center.array() + radius).matrix());
+  }
+
+  void growBounds(const InstancePose& pose) {
+    Eigen::Vector3d min = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+    Eigen::Vector3d max = Eigen::Vector3d::Constant(std::numeric_limits<double>::lowest());
+    if (this->hasBounds()) {
+      min = this->bounding_box_mesh.min();
+      max = this->bounding_box_mesh.max();
+    }
+    addToBounds(pose, min, max);
+    this->setBoundingBox(utils::MinMax3d<double>(min, max));
+  }
+
+  void fitBounds() {
+    if (instances.empty()) {
+      this->setBoundingBox(utils::MinMax3d<double>());
+      return;
+    }
+    Eigen::Vector3d min = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+    Eigen::Vector3d max = Eigen::Vector3d::Constant(std::numeric_limits<double>::lowest());
+    for (const InstancePose& pose : instances) {
+      addToBounds(pose, min, max);
+    }
+    this->setBoundingBox(utils::MinMax3d<double>(min, max));
+  }
+
+  unsigned int instance_VBO = 0;
+  InstancePoses instances;
+  bool has_changed = true;
+  // the bounding sphere of the geometry
+  Eigen::Vector3d geometry_center = Eigen::Vector3d::Zero();
+  double geometry_radius = 0.;
+
+  static constexpr const char* SHADER_IN_INSTANCE_ROW_NAME = "instanceRow";
+};
+
+#endif
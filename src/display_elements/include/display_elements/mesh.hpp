@@ -9,6 +9,7 @@
 #include <QOpenGLFunctions>
 #include <array>
 #include <display_elements/displayUtils.hpp>
+#include <display_elements/frustum.hpp>
 #include <display_elements/shaderProgram.hpp>
 #include <display_elements/vertex.hpp>
 #include <globals/globals.hpp>
@@ -16,6 +17,7 @@
 #include <string>
 #include <utils/eigen_conversations.hpp>
 #include <utils/eigen_glm_conversation.hpp>
+#include <utils/minmax.hpp>
 #include <vector>
 
 #include "light.hpp"
@@ -47,6 +49,38 @@ class BaseMesh {
     debug_normals = debug;
   }
 
+  /*!
+   * \brief Sets the box around the mesh in the frame of the mesh, Mesh::init() fits it to the
+   * vertices. Meshes without a box are never culled.
+   */
+  void setBoundingBox(const utils::MinMax3d<double>& box_mesh) {
+    bounding_box_mesh = box_mesh;
+    updateBounds();
+  }
+
+  bool hasBounds() const { return bounding_box_mesh.isInitiated(); }
+
+  // in world coordinates
+  const utils::MinMax3d<double>& getBoundingBox() const { return bounding_box; }
+
+  // in world coordinates
+  const Eigen::Vector3d& getBoundingSphereCenter() const { return bounding_sphere_center; }
+
+  double getBoundingSphereRadius() const { return bounding_sphere_radius; }
+
+  /*!
+   * \brief False if the mesh is certainly outside of the frustum, then drawing it can be
+   * skipped. First tests the bounding sphere, which is cheaper, then the bounding box.
+   * \param frustum In world coordinates.
+   */
+  bool isInside(const Frustum& frustum) const {
+    if (!hasBounds()) {
+      return true;
+    }
+    return !frustum.isOutside(bounding_sphere_center, bounding_sphere_radius) &&
+           !frustum.isOutside(bounding_box);
+  }
+
   void setTransformMesh2World(const Eigen::Isometry3d& p) {
     transform_mesh2world = p;
     updatePose();
@@ -67,6 +101,7 @@ class BaseMesh {
     transform_mesh2world.translate(-diff);
     transform_mesh2world.rotate(eigen_utils::rpy2RotationMatrix(rpy));
     transform_mesh2world.translate(diff);
+    updateBounds();
   }
 
   // view is camera transformation world2camera
@@ -206,9 +241,17 @@ class BaseMesh {
 
   void addShaddow(QObject* parent = nullptr) {
     const std::string path = Globals::getInstance().getAbsPath2Shaders();
-    const std::string shadow_vs = path + "shadow_mapping.vs";
-    const std::string shadow_fs = path + "shadow_mapping.fs";
+    addShaddow(path + "shadow_mapping.vs", path + "shadow_mapping.fs", parent);
+  }
 
+  /*!
+   * \brief Loads and connects a shadow shader other than the default one.
+   * \param shadow_vs The path to the vertex shader file.
+   * \param shadow_fs The path to the fragment shader file.
+   */
+  void addShaddow(const std::string& shadow_vs,
+                  const std::string& shadow_fs,
+                  QObject* parent = nullptr) {
     shader_shadow = std::make_shared<ShaderProgram>(parent);
     if (!shader_shadow->addCacheableShaderFromSourceFile(
             QOpenGLShader::Vertex, QString::fromStdString(shadow_vs))) {
@@ -374,12 +417,29 @@ class BaseMesh {
   Eigen::Projective3d projection = Eigen::Projective3d::Identity();
   Eigen::Isometry3d view = Eigen::Isometry3d::Identity();
   Material material;
+  // around the vertices, in the frame of the mesh and in world coordinates
+  utils::MinMax3d<double> bounding_box_mesh;
+  utils::MinMax3d<double> bounding_box;
+  Eigen::Vector3d bounding_sphere_center = Eigen::Vector3d::Zero();
+  double bounding_sphere_radius = 0.;
   bool debug_normals = false;
   bool is_initialized = false;
   std::shared_ptr<BaseMesh> normals = nullptr;
 
  private:
+  void updateBounds() {
+    if (!hasBounds()) {
+      return;
+    }
+    // The box turns with the mesh, the sphere around it does not change its size.
+    bounding_box = utils::MinMax3d<double>();
+    bounding_box.fitOutside(transform_mesh2world, bounding_box_mesh);
+    bounding_sphere_center = transform_mesh2world * bounding_box_mesh.center();
+    bounding_sphere_radius = 0.5 * (bounding_box_mesh.max() - bounding_box_mesh.min()).norm();
+  }
+
   void updatePose() {
+    updateBounds();
     if (shader_camera != nullptr) {
       glCheck(shader_camera->use());
       glCheck(shader_camera->setMat4(SHADER_UNIFORM_POSE_NAME,
@@ -441,6 +501,16 @@ class Mesh : public BaseMesh {
     if (this->indices.size() % 3 != 0) {
       ASSERT("Given number of indices is not divisible by 3.");
     }
+    if constexpr (has_position) {
+      std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d>> positions;
+      positions.reserve(this->vertices.size());
+      for (const VertexType& vertex : this->vertices) {
+        positions.emplace_back(vertex.position[0], vertex.position[1], vertex.position[2]);
+      }
+      utils::MinMax3d<double> box;
+      box.fit(positions);
+      setBoundingBox(box);
+    }
     setupMesh();
     is_initialized = true;
   }
@@ -543,6 +613,7 @@ class Mesh : public BaseMesh {
     glCheck(gl->glBindVertexArray(0));
   }
 
+ protected:
   /*!
    * \brief Connects the vertex shadow shader input variables with the vertex
    * array. The input variables expected in the shader are: in vec3 meshPos;
@@ -641,6 +712,7 @@ class Mesh : public BaseMesh {
     glCheck(gl->glBindVertexArray(0));
   }
 
+ private:
   void calculateNormalMesh() override {
 
     // put very tall tetraeder on center of every vertex triangle as a normal.
@@ -0,0 +1,194 @@
+#include "terrainMesh.h"
+
+#include <algorithm>
+
+TerrainMesh::TerrainMesh(const TerrainQuadtree::Settings& settings,
+                         const TerrainQuadtree::HeightSampler& heights,
+                         float max_height)
+    : quadtree(settings, heights), max_height(max_height) {
+  setupBuffers();
+  loadShader();
+  addShaddow();
+  setMaterial(Chrome());
+  setObjectTextures();
+  loadTexture(Globals::getInstance().getAbsPath2Resources() + "wall.jpg");
+  is_initialized = true;
+}
+
+void TerrainMesh::setHeights(const TerrainQuadtree::HeightSampler& heights,
+                             float max_height,
+                             unsigned int max_level) {
+  quadtree.setHeights(heights);
+  quadtree.setMaxLevel(max_level);
+  this->max_height = max_height;
+}
+
+void TerrainMesh::setupBuffers() {
+  QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+  glCheck(gl->glGenVertexArrays(1, &VAO));
+  glCheck(gl->glGenBuffers(1, &VBO));
+  glCheck(gl->glGenBuffers(1, &EBO));
+
+  if (VAO == 0 || VBO == 0 || EBO == 0) {
+    ASSERT("Do we have Context?!?!?!");
+  }
+
+  const size_t num_slots = quadtree.getSettings().max_patches;
+  const size_t vertices_per_patch = quadtree.getVerticesPerPatch();
+  glCheck(gl->glBindVertexArray(VAO));
+  // filled slot by slot in update()
+  glCheck(gl->glBindBuffer(GL_ARRAY_BUFFER, VBO));
+  glCheck(gl->glBufferData(GL_ARRAY_BUFFER,
+                           num_slots * vertices_per_patch * sizeof(VertexType),
+                           nullptr,
+                           GL_DYNAMIC_DRAW));
+
+  // the same for every slot, see drawPatches()
+  const std::vector<uint32_t> patch_indices = quadtree.getPatchIndices();
+  glCheck(gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO));
+  glCheck(gl->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                           patch_indices.size() * sizeof(uint32_t),
+                           patch_indices.data(),
+                           GL_STATIC_DRAW));
+
+  // The vertex buffer stays bound, connectShader() points the attributes into it.
+  glCheck(gl->glBindVertexArray(0));
+}
+
+void TerrainMesh::loadShader() {
+  const std::string path = Globals::getInstance().getAbsPath2Shaders();
+  const std::string vs = path + "camera.vs";
+  const std::string fs = path + "camera.fs";
+  Mesh::loadShader(vs, fs);
+}
+
+void TerrainMesh::update(int viewport_height) {
+  // the camera in the frame of the planet
+  const Eigen::Vector3d camera_world = view.inverse().translation();
+  const Eigen::Vector3d camera = transform_mesh2world.inverse() * camera_world;
+  // the projection scales y by 1 / tan(vertical_field_of_view / 2)
+  const double projection_scale = 0.5 * viewport_height * projection.matrix()(1, 1);
+  const Frustum frustum(projection.matrix() * view.matrix() * transform_mesh2world.matrix());
+  if (light && light->hasShadow()) {
+    const Frustum shadow_frustum(light->getLightSpaceMatrix().matrix().cast<double>() *
+                                 transform_mesh2world.matrix());
+    quadtree.select(
+        camera.cast<float>(), static_cast<float>(projection_scale), &frustum, &shadow_frustum);
+  } else {
+    quadtree.select(camera.cast<float>(), static_cast<float>(projection_scale), &frustum);
+  }
+
+  const std::vector<TerrainQuadtree::Upload>& uploads = quadtree.getUploads();
+  if (uploads.empty()) {
+    return;
+  }
+  QOpenGLExtraFunctions* gl = QOpenGLContext::currentContext()->extraFunctions();
+  glCheck(gl->glBindBuffer(GL_ARRAY_BUFFER, VBO));
+  const size_t vertices_per_patch = quadtree.getVerticesPerPatch();
+  const std::vector<TerrainQuadtree::Vertex>& built = quadtree.getUploadedVertices();
+  patch_vertices.resize(vertices_per_patch);
+  for (const TerrainQuadtree::Upload& upload : uploads) {
+    for (size_t i = 0; i < vertices_per_patch; i++) {
+      const TerrainQuadtree::Vertex& vertex = built[upload.first_vertex + i];
+      VertexType& v = patch_vertices[i];
+      std::copy(vertex.position.data(), vertex.position.data() + 3, v.position);
+      std::copy(vertex.normal.data(), vertex.normal.data() + 3, v.normal);
+      v.texture_pos[0] = TEXTURE_REPEAT * vertex.u;
+      v.texture_pos[1] = TEXTURE_REPEAT * vertex.v;
+      setColor(vertex.height, v.color);
+    }
+    glCheck(gl->glBufferSubData(GL_ARRAY_BUFFER,
+                                upload.slot * vertices_per_patch * sizeof(VertexType),
+                                vertices_per_patch * sizeof(VertexType),
+                                patch_vertices.data()));
+
+    // the roots for the debug normals
+    if (upload.key < 6) {
+      if (vertices.size() >= 6 * vertices_per_patch) {
+        vertices.clear();
+        indices.clear();
+      }
+      const unsigned int first_vertex = static_cast<unsigned int>(vertices.size());
+      vertices.insert(vertices.end(), patch_vertices.begin(), patch_vertices.end());
+      for (const uint32_t index : quadtree.getPatchIndices()) {
+        indices.push_back(first_vertex + index);
+      }
+    }
+  }
+  glCheck(gl->glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
+void TerrainMesh::setColor(float height, float* color) const {
+  const float h = std::clamp(height / std::max(max_height, 1e-9f), -1.f, 1.f);
+  if (h < 0.f) {
+    // deep blue to shallow blue
+    color[0] = 0.f;
+    color[1] = 0.2f + 0.2f * (1.f + h);
+    color[2] = 0.5f + 0.5f * (1.f + h);
+  } else if (h < 0.5f) {
+    // green to brown
+    const float t = 2.f * h;
+    color[0] = 0.2f + 0.3f * t;
+    color[1] = 0.6f - 0.25f * t;
+    color[2] = 0.2f;
+  } else {
+    // brown to snow
+    const float t = 2.f * (h - 0.5f);
+    color[0] = 0.5f + 0.5f * t;
+    color[1] = 0.35f + 0.65f * t;
+    color[2] = 0.2f + 0.8f * t;
+  }
+}
+
+void TerrainMesh::drawPatches(QOpenGLExtraFunctions* gl, const std::vector<uint32_t>& slots) {
+  const size_t indices_per_patch = quadtree.getIndicesPerPatch();
+  const size_t vertices_per_patch = quadtree.getVerticesPerPatch();
+  glCheck(gl->glBindVertexArray(VAO));
+  for (const uint32_t slot : slots) {
+    glCheck(gl->glDrawElementsBaseVertex(GL_TRIANGLES,
+                                         static_cast<GLsizei>(indices_per_patch),
+                                         GL_UNSIGNED_INT,
+                                         nullptr,
+                                         static_cast<GLint>(slot * vertices_per_patch)));
+  }
+  glCheck(gl->glBindVertexArray(0));
+}
+
+void TerrainMesh::draw(QOpenGLExtraFunctions* gl) {
+  if (shader_camera == nullptr) {
+    return;
+  }
+
+  glCheck(shader_camera->use());
+
+  glCheck(gl->glActiveTexture(GL_TEXTURE0 + SHADER_UNIFORM_CAMERA_OBJECT_TEXTURE_ID));
+  glCheck(gl->glBindTexture(GL_TEXTURE_2D, texture));
+
+  if (light && light->hasShadow()) {
+    glCheck(gl->glActiveTexture(GL_TEXTURE0 + SHADER_UNIFORM_CAMERA_SHADOW_TEXTURE_ID));
+    glCheck(gl->glBindTexture(GL_TEXTURE_2D, light->getDepthMapTexture()));
+  }
+
+  drawPatches(gl, quadtree.getSelection());
+
+  glCheck(gl->glActiveTexture(GL_TEXTURE0));
+  glCheck(gl->glBindTexture(GL_TEXTURE_2D, 0));
+  glCheck(gl->glActiveTexture(GL_TEXTURE1));
+  glCheck(gl->glBindTexture(GL_TEXTURE_2D, 0));
+
+  glCheck(shader_camera->release());
+
+  if (debug_normals && normals) {
+    normals->draw(gl);
+  }
+}
+
+void TerrainMesh::drawShadows(QOpenGLExtraFunctions* gl) {
+  if (light == nullptr || !light->hasShadow() || shader_shadow == nullptr) {
+    return;
+  }
+  glCheck(shader_shadow->use());
+  // also the terrain outside of the view which casts shadows into it
+  drawPatches(gl, quadtree.getShadowSelection());
+  shader_shadow->release();
+}
@@ -0,0 +1,68 @@
+#ifndef TERRAIN_MESH
+#define TERRAIN_MESH
+
+#include <Eigen/Geometry>
+#include <display_elements/mesh.hpp>
+#include <globals/globals.hpp>
+#include <globals/macros.hpp>
+
+#include "terrainQuadtree.h"
+
+/*!
+ * \brief The planet in the resolution the view needs, see TerrainQuadtree.
+ * The vertex buffer has a slot for each of the max_patches patches the quadtree keeps, a
+ * patch is copied into its slot with glBufferSubData() when it is built. Since all patches
+ * have the same triangles, the index buffer holds the indices of one patch and every selected
+ * patch is one glDrawElementsBaseVertex() call starting at its slot. The mesh has no bounding
+ * box, the quadtree culls its patches instead, for the camera and for the shadow map.
+ * The debug normals show the 6 coarsest patches.
+ */
+class TerrainMesh : public Mesh<true, true, false, false, true, true, 3> {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  TerrainMesh(const TerrainQuadtree::Settings& settings,
+              const TerrainQuadtree::HeightSampler& heights,
+              float max_height);
+
+  /*!
+   * \brief Replaces the heights, the patches are rebuilt over the next frames.
+   * \param max_height [mesh units] The height colored as the highest peaks.
+   * \param max_level See TerrainQuadtree::getMaxLevel().
+   */
+  void setHeights(const TerrainQuadtree::HeightSampler& heights,
+                  float max_height,
+                  unsigned int max_level);
+
+  /*!
+   * \brief Selects the patches for the current view and the light and uploads the ones built
+   * for them. Call once per frame before drawing.
+   * \param viewport_height [pixel] Of the main pass.
+   */
+  void update(int viewport_height);
+
+  void draw(QOpenGLExtraFunctions* gl) override;
+
+  void drawShadows(QOpenGLExtraFunctions* gl) override;
+
+  const TerrainQuadtree& getQuadtree() const { return quadtree; }
+
+ private:
+  void setupBuffers();
+
+  void loadShader();
+
+  void drawPatches(QOpenGLExtraFunctions* gl, const std::vector<uint32_t>& slots);
+
+  void setColor(float height, float* color) const;
+
+  TerrainQuadtree quadtree;
+  // [mesh units]
+  float max_height;
+  // the vertices of a patch as uploaded
+  std::vector<VertexType> patch_vertices;
+
+  // wall.jpg repeats this often along the edge of a cube face
+  static constexpr float TEXTURE_REPEAT = 16.f;
+};
+
+#endif
@@ -0,0 +1,381 @@
+#include "terrainQuadtree.h"
+
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cmath>
+#include <display_elements/frustum.hpp>
+#include <limits>
+
+namespace {
+
+constexpr double QUARTER_PI = 0.78539816339744831;
+
+// The normal of a cube face and its column (u) and row (v) axes, u x v = normal.
+struct Face {
+  Eigen::Vector3f normal;
+  Eigen::Vector3f u;
+  Eigen::Vector3f v;
+};
+
+const Face FACES[6] = {
+    {Eigen::Vector3f(1, 0, 0), Eigen::Vector3f(0, 1, 0), Eigen::Vector3f(0, 0, 1)},
+    {Eigen::Vector3f(-1, 0, 0), Eigen::Vector3f(0, -1, 0), Eigen::Vector3f(0, 0, 1)},
+    {Eigen::Vector3f(0, 1, 0), Eigen::Vector3f(-1, 0, 0), Eigen::Vector3f(0, 0, 1)},
+    {Eigen::Vector3f(0, -1, 0), Eigen::Vector3f(1, 0, 0), Eigen::Vector3f(0, 0, 1)},
+    {Eigen::Vector3f(0, 0, 1), Eigen::Vector3f(0, 1, 0), Eigen::Vector3f(-1, 0, 0)},
+    {Eigen::Vector3f(0, 0, -1), Eigen::Vector3f(0, 1, 0), Eigen::Vector3f(1, 0, 0)}};
+
+// How far the skirts hang down, in errors of the patch. Covers the crack to a neighbour one
+// level coarser, whose error is about twice as large.
+constexpr float SKIRT_ERRORS = 3.f;
+// and in quads of the patch, for flat patches
+constexpr float SKIRT_QUADS = 0.05f;
+
+// The grid vertex of the skirt vertex k, counterclockwise around the patch seen from outside.
+void getRingVertex(unsigned int k, unsigned int n, unsigned int& i, unsigned int& j) {
+  if (k < n) {
+    i = k;
+    j = 0;
+  } else if (k < 2 * n) {
+    i = n;
+    j = k - n;
+  } else if (k < 3 * n) {
+    i = 3 * n - k;
+    j = n;
+  } else {
+    i = 0;
+    j = 4 * n - k;
+  }
+}
+}  // namespace
+
+void TerrainQuadtree::init(const Settings& settings, const HeightSampler& heights) {
+  this->settings = settings;
+  this->settings.max_patches = std::max<size_t>(6, settings.max_patches);
+  this->settings.patch_size = std::max(1u, settings.patch_size);
+  this->heights = heights;
+  resident.clear();
+  resident.reserve(this->settings.max_patches);
+  free_slots.resize(this->settings.max_patches);
+  // the lowest slot first
+  for (size_t s = 0; s < free_slots.size(); s++) {
+    free_slots[s] = static_cast<uint32_t>(free_slots.size() - 1 - s);
+  }
+  occluder_radius = settings.radius;
+  frame = 0;
+  selection.clear();
+  shadow_selection.clear();
+  uploads.clear();
+  uploaded_vertices.clear();
+}
+
+void TerrainQuadtree::setHeights(const HeightSampler& heights) {
+  this->heights = heights;
+  for (auto& patch : resident) {
+    patch.second.is_stale = true;
+  }
+}
+
+void TerrainQuadtree::select(const Eigen::Vector3f& camera_position,
+                             float projection_scale,
+                             const Frustum* frustum,
+                             const Frustum* shadow_frustum) {
+  this->camera_position = camera_position;
+  this->projection_scale = projection_scale;
+  this->frustum = frustum;
+  this->shadow_frustum = shadow_frustum;
+  frame++;
+  selection.clear();
+  shadow_selection.clear();
+  requests.clear();
+  shadow_requests.clear();
+  stale_selected.clear();
+  uploads.clear();
+  uploaded_vertices.clear();
+
+  for (uint64_t face = 0; face < 6; face++) {
+    if (resident.find(face) == resident.end()) {
+      build(face);
+    }
+  }
+  for (uint64_t face = 0; face < 6; face++) {
+    visit(face, resident.at(face), false);
+  }
+  if (shadow_frustum != nullptr) {
+    for (uint64_t face = 0; face < 6; face++) {
+      visit(face, resident.at(face), true);
+    }
+  }
+
+  // the patches whose parents are the furthest off on screen first, those of the camera before
+  // those of the shadows
+  const auto by_priority = [](const Request& a, const Request& b) {
+    return a.priority > b.priority;
+  };
+  std::stable_sort(requests.begin(), requests.end(), by_priority);
+  std::stable_sort(shadow_requests.begin(), shadow_requests.end(), by_priority);
+  requests.insert(requests.end(), shadow_requests.begin(), shadow_requests.end());
+  for (const Request& request : requests) {
+    if (uploads.size() >= settings.max_uploads_per_frame) {
+      break;
+    }
+    // requested by both walks
+    if (resident.find(request.key) != resident.end()) {
+      continue;
+    }
+    if (!build(request.key)) {
+      break;
+    }
+  }
+  for (const uint64_t key : stale_selected) {
+    if (uploads.size() >= settings.max_uploads_per_frame) {
+      break;
+    }
+    if (resident.at(key).is_stale) {
+      build(key);
+    }
+  }
+  this->frustum = nullptr;
+  this->shadow_frustum = nullptr;
+}
+
+void TerrainQuadtree::visit(uint64_t key, Patch& patch, bool for_shadows) {
+  // Visited patches are kept, build() only evicts those not used in this frame.
+  patch.last_used = frame;
+  const Frustum* culling = for_shadows ? shadow_frustum : frustum;
+  if ((!for_shadows && isBehindHorizon(patch)) ||
+      (culling != nullptr &&
+       culling->isOutside(patch.center.cast<double>(), patch.bounding_radius))) {
+    return;
+  }
+  const float error = getScreenError(patch);
+  if (patch.level < settings.max_level && error > settings.max_pixel_error) {
+    Patch* children[4];
+    bool has_children = true;
+    for (unsigned int c = 0; c < 4; c++) {
+      const uint64_t child = getChild(key, c);
+      const auto found = resident.find(child);
+      if (found == resident.end()) {
+        (for_shadows ? shadow_requests : requests).push_back({child, error});
+        has_children = false;
+        children[c] = nullptr;
+      } else {
+        // keep it, even if it is not drawn yet
+        found->second.last_used = frame;
+        children[c] = &found->second;
+      }
+    }
+    if (has_children) {
+      for (unsigned int c = 0; c < 4; c++) {
+        visit(getChild(key, c), *children[c], for_shadows);
+      }
+      return;
+    }
+  }
+  (for_shadows ? shadow_selection : selection).push_back(patch.slot);
+  if (patch.is_stale) {
+    stale_selected.push_back(key);
+  }
+}
+
+bool TerrainQuadtree::build(uint64_t key) {
+  auto found = resident.find(key);
+  uint32_t slot;
+  if (found != resident.end()) {
+    slot = found->second.slot;
+  } else if (!free_slots.empty()) {
+    slot = free_slots.back();
+    free_slots.pop_back();
+  } else {
+    // the least recently used patch which is not needed in this frame, never a root
+    auto oldest = resident.end();
+    for (auto it = resident.begin(); it != resident.end(); ++it) {
+      if (it->first >= 6 && it->second.last_used < frame &&
+          (oldest == resident.end() || it->second.last_used < oldest->second.last_used)) {
+        oldest = it;
+      }
+    }
+    if (oldest == resident.end()) {
+      return false;
+    }
+    slot = oldest->second.slot;
+    resident.erase(oldest);
+  }
+
+  const size_t first_vertex = uploaded_vertices.size();
+  uploaded_vertices.resize(first_vertex + getVerticesPerPatch());
+  Patch& patch = resident[key];
+  patch.slot = slot;
+  patch.last_used = frame;
+  patch.is_stale = false;
+  buildVertices(key, uploaded_vertices.data() + first_vertex, patch);
+  occluder_radius = std::min(occluder_radius, patch.min_radius);
+  uploads.push_back({slot, key, first_vertex});
+  return true;
+}
+
+void TerrainQuadtree::buildVertices(uint64_t key, Vertex* vertices, Patch& patch) const {
+  // from the key back to the root
+  unsigned int level = 0;
+  uint64_t x = 0;
+  uint64_t y = 0;
+  uint64_t face = key;
+  while (face >= 6) {
+    const uint64_t child = (face - 6) % 4;
+    x |= (child & 1u) << level;
+    y |= (child >> 1) << level;
+    face = (face - 6) / 4;
+    level++;
+  }
+  patch.level = level;
+
+  // The surface in half quads, with a ring around the patch for the normals. The samples
+  // between the vertices measure how far the patch is from the next finer level.
+  const unsigned int n = settings.patch_size;
+  const long samples_per_row = 2 * n + 3;
+  const double quads_per_face = static_cast<double>(n) * static_cast<double>(1ull << level);
+  const double half_quad = QUARTER_PI / quads_per_face;
+  const Face& f = FACES[face];
+  samples.resize(static_cast<size_t>(samples_per_row * samples_per_row));
+  for (long j = 0; j < samples_per_row; j++) {
+    const double b = -QUARTER_PI + (static_cast<double>(2 * n * y) + j - 1) * half_quad;
+    const float tan_b = static_cast<float>(std::tan(b));
+    for (long i = 0; i < samples_per_row; i++) {
+      const double a = -QUARTER_PI + (static_cast<double>(2 * n * x) + i - 1) * half_quad;
+      const float tan_a = static_cast<float>(std::tan(a));
+      const Eigen::Vector3f direction = (f.normal + tan_a * f.u + tan_b * f.v).normalized();
+      samples[j * samples_per_row + i] = direction * (settings.radius + heights(direction));
+    }
+  }
+  // the sample at half quad (i, j) of the patch
+  const auto sample = [&](long i, long j) -> const Eigen::Vector3f& {
+    return samples[(j + 1) * samples_per_row + i + 1];
+  };
+
+  float error = 0.f;
+  for (long j = 0; j <= 2 * static_cast<long>(n); j++) {
+    for (long i = 0; i <= 2 * static_cast<long>(n); i++) {
+      const bool odd_i = i % 2 == 1;
+      const bool odd_j = j % 2 == 1;
+      if (!odd_i && !odd_j) {
+        continue;
+      }
+      // the triangles of a quad split along the diagonal (i, j) to (i + 1, j + 1)
+      const Eigen::Vector3f interpolated =
+          0.5f * (sample(odd_i ? i - 1 : i, odd_j ? j - 1 : j) +
+                  sample(odd_i ? i + 1 : i, odd_j ? j + 1 : j));
+      error = std::max(error, (sample(i, j) - interpolated).norm());
+    }
+  }
+  patch.error = error;
+
+  const float quad_size = static_cast<float>(2. * half_quad) * settings.radius;
+  const float skirt = SKIRT_ERRORS * error + SKIRT_QUADS * quad_size;
+  Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector3f max = Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  float min_radius = std::numeric_limits<float>::max();
+  for (unsigned int j = 0; j <= n; j++) {
+    for (unsigned int i = 0; i <= n; i++) {
+      const long si = 2 * static_cast<long>(i);
+      const long sj = 2 * static_cast<long>(j);
+      Vertex& vertex = vertices[j * (n + 1) + i];
+      vertex.position = sample(si, sj);
+      vertex.normal =
+          (sample(si + 1, sj) - sample(si - 1, sj)).cross(sample(si, sj + 1) - sample(si, sj - 1));
+      vertex.normal.normalize();
+      const float r = vertex.position.norm();
+      vertex.height = r - settings.radius;
+      vertex.u = static_cast<float>((static_cast<double>(n * x + i)) / quads_per_face);
+      vertex.v = static_cast<float>((static_cast<double>(n * y + j)) / quads_per_face);
+      min = min.cwiseMin(vertex.position);
+      max = max.cwiseMax(vertex.position);
+      min_radius = std::min(min_radius, r);
+    }
+  }
+
+  const size_t num_grid = static_cast<size_t>(n + 1) * (n + 1);
+  for (unsigned int k = 0; k < 4 * n; k++) {
+    unsigned int i, j;
+    getRingVertex(k, n, i, j);
+    Vertex& vertex = vertices[num_grid + k];
+    vertex = vertices[j * (n + 1) + i];
+    vertex.position -= vertex.position.normalized() * skirt;
+    min = min.cwiseMin(vertex.position);
+    max = max.cwiseMax(vertex.position);
+  }
+
+  patch.center = 0.5f * (min + max);
+  patch.bounding_radius = 0.5f * (max - min).norm();
+  patch.min_radius = min_radius - skirt;
+}
+
+float TerrainQuadtree::getScreenError(const Patch& patch) const {
+  const float distance = std::max((patch.center - camera_position).norm() - patch.bounding_radius,
+                                  1e-4f * settings.radius);
+  return patch.error * projection_scale / distance;
+}
+
+bool TerrainQuadtree::isBehindHorizon(const Patch& patch) const {
+  // A point is seen over the occluding sphere only if it is no further away than the distance
+  // from the camera to the horizon plus the distance from the horizon to the point.
+  const float r2 = occluder_radius * occluder_radius;
+  const float camera_horizon2 = camera_position.squaredNorm() - r2;
+  if (camera_horizon2 <= 0.f) {
+    return false;
+  }
+  const float distance = (patch.center - camera_position).norm() - patch.bounding_radius;
+  const float top = patch.center.norm() + patch.bounding_radius;
+  const float patch_horizon = std::sqrt(std::max(0.f, top * top - r2));
+  return distance > std::sqrt(camera_horizon2) + patch_horizon;
+}
+
+std::vector<uint32_t> TerrainQuadtree::getPatchIndices() const {
+  const uint32_t n = settings.patch_size;
+  std::vector<uint32_t> indices;
+  indices.reserve(getIndicesPerPatch());
+  const auto grid = [n](uint32_t i, uint32_t j) { return j * (n + 1) + i; };
+  // counterclockwise seen from outside
+  for (uint32_t j = 0; j < n; j++) {
+    for (uint32_t i = 0; i < n; i++) {
+      indices.insert(indices.end(),
+                     {grid(i, j), grid(i + 1, j), grid(i + 1, j + 1), grid(i, j), grid(i + 1, j + 1),
+                      grid(i, j + 1)});
+    }
+  }
+  // the skirt faces outwards, into the crack
+  const uint32_t first_skirt = (n + 1) * (n + 1);
+  for (uint32_t k = 0; k < 4 * n; k++) {
+    const uint32_t next = (k + 1) % (4 * n);
+    unsigned int i, j, next_i, next_j;
+    getRingVertex(k, n, i, j);
+    getRingVertex(next, n, next_i, next_j);
+    const uint32_t top = grid(i, j);
+    const uint32_t next_top = grid(next_i, next_j);
+    indices.insert(indices.end(),
+                   {top, first_skirt + k, first_skirt + next, top, first_skirt + next, next_top});
+  }
+  return indices;
+}
+
+size_t TerrainQuadtree::getVerticesPerPatch() const {
+  const size_t n = settings.patch_size;
+  return (n + 1) * (n + 1) + 4 * n;
+}
+
+size_t TerrainQuadtree::getIndicesPerPatch() const {
+  const size_t n = settings.patch_size;
+  return 6 * n * n + 6 * 4 * n;
+}
+
+unsigned int TerrainQuadtree::getMaxLevel(size_t num_samples, unsigned int patch_size) {
+  unsigned int level = 0;
+  // deeper keys overflow 64 bit
+  while (level < MAX_LEVEL) {
+    const double edge = static_cast<double>(patch_size) * static_cast<double>(1ull << level);
+    if (6. * edge * edge >= static_cast<double>(num_samples)) {
+      break;
+    }
+    level++;
+  }
+  return level;
+}
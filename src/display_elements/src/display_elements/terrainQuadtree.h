@@ -0,0 +1,225 @@
+#ifndef TERRAIN_QUADTREE
+#define TERRAIN_QUADTREE
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class Frustum;
+
+/*!
+ * \brief Chooses which parts of a planet to draw in which resolution (chunked LOD).
+ * The planet is the 6 faces of a cube projected onto a sphere (equiangular, as in the
+ * CubedSphere of the world). Every face is the root of a quadtree whose nodes are patches of
+ * patch_size * patch_size quads, a child covers a quarter of its parent with the same number
+ * of quads. Each frame select() walks the trees from the roots and refines a patch as long as
+ * its geometric error, projected onto the screen, exceeds max_pixel_error. Patches behind the
+ * horizon or outside of the view frustum are skipped together with their children.
+ * Only resident patches are drawn: their vertices are in one of max_patches slots of a vertex
+ * buffer. Missing patches are built and handed to the renderer to upload, at most
+ * max_uploads_per_frame per frame, the most needed ones first; until all 4 children are
+ * resident the parent is drawn. When the slots run out the least recently used patch is
+ * evicted. Thus the number of vertices uploaded and drawn depends on the view and not on the
+ * number of height samples of the planet.
+ * Patches of different levels meet with cracks which are hidden by skirts: a strip hanging
+ * down from the border of every patch.
+ * The shadow map needs the patches the light sees, which includes terrain outside of the view
+ * and behind the horizon. select() walks the trees a second time for the light frustum, with
+ * the resolution chosen for the camera; its missing patches are built after those of the
+ * camera.
+ * No OpenGL here, see TerrainMesh.
+ */
+class TerrainQuadtree {
+ public:
+  /*!
+   * \brief The height of the surface above the sphere.
+   * \param direction From the center of the planet, unit length.
+   * \return [mesh units] The height, may be negative.
+   */
+  typedef std::function<float(const Eigen::Vector3f& direction)> HeightSampler;
+
+  struct Settings {
+    // [mesh units] of the sphere at height 0
+    float radius = 0.6f;
+    // quads along the edge of a patch
+    unsigned int patch_size = 32;
+    // of the finest patches, see getMaxLevel()
+    unsigned int max_level = 7;
+    // [pixel] refine a patch if it misplaces the surface by more on screen
+    float max_pixel_error = 2.f;
+    // slots of the vertex buffer, at least 6
+    size_t max_patches = 1024;
+    // patches built per frame, the 6 roots are always built
+    size_t max_uploads_per_frame = 12;
+  };
+
+  struct Vertex {
+    Eigen::Vector3f position;
+    Eigen::Vector3f normal;
+    // [mesh units] above the sphere
+    float height;
+    // the position on the face in [0, 1]
+    float u;
+    float v;
+  };
+
+  // A patch built in select(), its getVerticesPerPatch() vertices go into slot.
+  struct Upload {
+    uint32_t slot;
+    uint64_t key;
+    size_t first_vertex;
+  };
+
+  TerrainQuadtree() = default;
+
+  TerrainQuadtree(const Settings& settings, const HeightSampler& heights) {
+    init(settings, heights);
+  }
+
+  /*!
+   * \brief Removes all patches, the next select() starts with the roots.
+   */
+  void init(const Settings& settings, const HeightSampler& heights);
+
+  /*!
+   * \brief Replaces the heights. The resident patches are kept and drawn until they are
+   * rebuilt, which counts against max_uploads_per_frame, those drawn first.
+   */
+  void setHeights(const HeightSampler& heights);
+
+  /*!
+   * \brief Limits the refinement, e.g. to getMaxLevel() of new heights. Deeper patches are no
+   * longer selected and evicted in time.
+   */
+  void setMaxLevel(unsigned int level) {
+    settings.max_level = level < MAX_LEVEL ? level : MAX_LEVEL;
+  }
+
+  /*!
+   * \brief Selects the patches to draw for a camera and builds missing ones.
+   * \param camera_position In the frame of the planet, whose center is the origin.
+   * \param projection_scale [pixel] The size on screen of 1 mesh unit at distance 1:
+   * viewport_height / (2 * tan(vertical_field_of_view / 2)).
+   * \param frustum Of the camera in the frame of the planet, nullptr to not cull.
+   * \param shadow_frustum Of the light in the frame of the planet, nullptr for no shadow
+   * selection.
+   */
+  void select(const Eigen::Vector3f& camera_position,
+              float projection_scale,
+              const Frustum* frustum = nullptr,
+              const Frustum* shadow_frustum = nullptr);
+
+  // The slots to draw after select().
+  const std::vector<uint32_t>& getSelection() const { return selection; }
+
+  // The slots to draw into the shadow map after select(), empty without shadow_frustum.
+  const std::vector<uint32_t>& getShadowSelection() const { return shadow_selection; }
+
+  // The patches built in the last select(), to be copied into their slots.
+  const std::vector<Upload>& getUploads() const { return uploads; }
+
+  // The vertices of getUploads(), getVerticesPerPatch() each.
+  const std::vector<Vertex>& getUploadedVertices() const { return uploaded_vertices; }
+
+  /*!
+   * \brief The triangles of a patch, 3 indices each, the same for every slot. Slot s is drawn
+   * with the base vertex s * getVerticesPerPatch().
+   */
+  std::vector<uint32_t> getPatchIndices() const;
+
+  /*!
+   * \brief The grid of (patch_size + 1)^2 vertices, row by row, followed by the 4 *
+   * patch_size vertices of the skirt.
+   */
+  size_t getVerticesPerPatch() const;
+
+  size_t getIndicesPerPatch() const;
+
+  size_t getNumResident() const { return resident.size(); }
+
+  const Settings& getSettings() const { return settings; }
+
+  /*!
+   * \brief The level whose patches have about as many vertices as the planet has height
+   * samples, finer patches would not show more details.
+   */
+  static unsigned int getMaxLevel(size_t num_samples, unsigned int patch_size);
+
+  // The roots are 0 to 5, the children of a patch 4 * key + 6 to 4 * key + 9.
+  static uint64_t getChild(uint64_t key, unsigned int child) { return 4 * key + 6 + child; }
+
+  static constexpr unsigned int MAX_LEVEL = 29;
+
+ private:
+  struct Patch {
+    uint32_t slot;
+    unsigned int level;
+    // of the bounding sphere
+    Eigen::Vector3f center;
+    float bounding_radius;
+    // [mesh units] the furthest the patch is from the surface it shows
+    float error;
+    // [mesh units] the lowest point of the patch
+    float min_radius;
+    uint64_t last_used;
+    bool is_stale;
+  };
+
+  struct Request {
+    uint64_t key;
+    float priority;
+  };
+
+  /*!
+   * \brief Selects the patch or its children. The patch is resident.
+   * \param for_shadows Into shadow_selection, culled by shadow_frustum and not by the horizon.
+   */
+  void visit(uint64_t key, Patch& patch, bool for_shadows);
+
+  /*!
+   * \brief Builds a patch into uploaded_vertices and a free or evicted slot.
+   * \return False if there was no slot.
+   */
+  bool build(uint64_t key);
+
+  /*!
+   * \brief Builds the vertices of a patch and its error and bounds.
+   */
+  void buildVertices(uint64_t key, Vertex* vertices, Patch& patch) const;
+
+  // [pixel] The error of the patch on screen, 0 if it is hidden behind the horizon.
+  float getScreenError(const Patch& patch) const;
+
+  bool isBehindHorizon(const Patch& patch) const;
+
+  Settings settings;
+  HeightSampler heights;
+
+  std::unordered_map<uint64_t, Patch> resident;
+  std::vector<uint32_t> free_slots;
+  uint64_t frame = 0;
+  // [mesh units] below every patch built so far, the sphere occluding the patches behind it
+  float occluder_radius = 0.f;
+
+  // of the current select()
+  Eigen::Vector3f camera_position = Eigen::Vector3f::Zero();
+  float projection_scale = 1.f;
+  const Frustum* frustum = nullptr;
+  const Frustum* shadow_frustum = nullptr;
+  std::vector<Request> requests;
+  std::vector<Request> shadow_requests;
+  std::vector<uint64_t> stale_selected;
+
+  std::vector<uint32_t> selection;
+  std::vector<uint32_t> shadow_selection;
+  std::vector<Upload> uploads;
+  std::vector<Vertex> uploaded_vertices;
+
+  // temporary samples of buildVertices()
+  mutable std::vector<Eigen::Vector3f> samples;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define WORLD_MESH
 
 #include <Eigen/Geometry>
+#include <display_elements/instancedMesh.hpp>
 #include <display_elements/mesh.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <globals/globals.hpp>
@@ -22,6 +23,35 @@ class WorldMesh : public Mesh<true, true, false, false, true, true, 3> {
 
   void loadVertices();
   void loadShader();
+
+  /*!
+   * \brief The planet with the coordinate axes.
+   */
+  static void getVertices(std::vector<VertexType>& vertices, std::vector<unsigned int>& indices);
+
+  static std::string getTexturePath();
+
+ private:
+  // 10 * 4^level + 2 vertices plus the seam, low since WorldMeshInstances draws 144 copies
+  static constexpr unsigned int PLANET_LEVEL = 2;
+  static constexpr float PLANET_RADIUS = 0.6f;
+};
+
+/*!
+ * \brief Copies of the WorldMesh drawn in one call, see InstancedMesh.
+ */
+class WorldMeshInstances : public InstancedMesh<true, true, false, false, true, true, 3> {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  WorldMeshInstances() {
+    std::vector<VertexType> vertices_temp;
+    std::vector<unsigned int> indices_temp;
+    WorldMesh::getVertices(vertices_temp, indices_temp);
+    init(vertices_temp, indices_temp, WorldMesh::getTexturePath());
+    loadInstancedShaders();
+    setMaterial(Chrome());
+    setObjectTextures();
+  }
 };
 
 #endif
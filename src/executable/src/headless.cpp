@@ -0,0 +1,236 @@
+#include <world/world.h>
+
+#include <cerrno>
+#include <chrono>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Arguments {
+  unsigned long long ticks = 1000;
+  unsigned int threads = 0;
+  unsigned long long snapshot_every = 0;
+  unsigned int keyframe_every = 1;
+  unsigned long long seed = 0;
+  erosion::Solver erosion = erosion::DROPLET_SOLVER;
+  double presimulate_days = 0.;
+  std::string snapshot_prefix = "world";
+};
+
+void printUsage(const char* name) {
+  printf(
+      "usage: %s [options]\n"
+      "Runs the simulation without any display.\n"
+      "  --ticks N           number of World::update() calls (default 1000)\n"
+      "  --threads N         number of simulation threads, 0 = all cores (default 0)\n"
+      "  --snapshot-every N  save the world every N ticks in the background,\n"
+      "                      0 = only at the end (default 0)\n"
+      "  --keyframe-every N  every N-th background snapshot is a full file, the others\n"
+      "                      only hold the changes since the previous one (default 1)\n"
+      "  --out PREFIX        snapshots are saved to PREFIX_<tick>.evsm (default world)\n"
+      "  --seed N            seed of the generated terrain (default 0)\n"
+      "  --erosion SOLVER    droplets or shallow-water, how the terrain is eroded\n"
+      "                      (default droplets)\n"
+      "  --presimulate DAYS  before the ticks run the weather until the world settles,\n"
+      "                      at most DAYS days, and save it to PREFIX_settled.evsm\n"
+      "                      (default 0 = off)\n",
+      name);
+}
+
+/*!
+ * \brief Parses a whole decimal number, rejects signs, trailing characters and overflow.
+ */
+template <typename T>
+bool parseUnsigned(const char* text, T& value) {
+  if (*text < '0' || *text > '9') {
+    return false;
+  }
+  char* end = nullptr;
+  errno = 0;
+  const unsigned long long parsed = std::strtoull(text, &end, 10);
+  if (errno != 0 || *end != '\0' || parsed > std::numeric_limits<T>::max()) {
+    return false;
+  }
+  value = static_cast<T>(parsed);
+  return true;
+}
+
+/*!
+ * \brief Parses a whole finite, not negative number.
+ */
+bool parseDouble(const char* text, double& value) {
+  char* end = nullptr;
+  errno = 0;
+  const double parsed = std::strtod(text, &end);
+  if (end == text || errno != 0 || *end != '\0' || !std::isfinite(parsed) || parsed < 0.) {
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+
+bool parseArguments(int argc, char* argv[], Arguments& args) {
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    bool is_valid = true;
+    if (strcmp(argv[i], "--ticks") == 0 && has_value) {
+      is_valid = parseUnsigned(argv[++i], args.ticks);
+    } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+      is_valid = parseUnsigned(argv[++i], args.threads);
+    } else if (strcmp(argv[i], "--snapshot-every") == 0 && has_value) {
+      is_valid = parseUnsigned(argv[++i], args.snapshot_every);
+    } else if (strcmp(argv[i], "--keyframe-every") == 0 && has_value) {
+      is_valid = parseUnsigned(argv[++i], args.keyframe_every);
+    } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+      is_valid = parseUnsigned(argv[++i], args.seed);
+    } else if (strcmp(argv[i], "--erosion") == 0 && has_value) {
+      i++;
+      if (strcmp(argv[i], "droplets") == 0) {
+        args.erosion = erosion::DROPLET_SOLVER;
+      } else if (strcmp(argv[i], "shallow-water") == 0) {
+        args.erosion = erosion::SHALLOW_WATER_SOLVER;
+      } else {
+        return false;
+      }
+    } else if (strcmp(argv[i], "--presimulate") == 0 && has_value) {
+      is_valid = parseDouble(argv[++i], args.presimulate_days);
+    } else if (strcmp(argv[i], "--out") == 0 && has_value) {
+      args.snapshot_prefix = argv[++i];
+    } else {
+      return false;
+    }
+    if (!is_valid) {
+      fprintf(stderr, "Invalid value %s for %s.\n", argv[i], argv[i - 1]);
+      return false;
+    }
+  }
+  return true;
+}
+
+void printBiomes(const std::vector<uint8_t>& biomes) {
+  size_t counts[biome::NUM_BIOMES] = {};
+  for (const uint8_t b : biomes) {
+    counts[b]++;
+  }
+  printf("Biomes:");
+  for (int b = 0; b < biome::NUM_BIOMES; b++) {
+    const double share = 100. * static_cast<double>(counts[b]) / static_cast<double>(biomes.size());
+    printf(" %s %.1f%%", biome::getName(static_cast<uint8_t>(b)), share);
+  }
+  printf("\n");
+}
+
+std::string getSnapshotFile(const Arguments& args, unsigned long long tick) {
+  return args.snapshot_prefix + "_" + std::to_string(tick) + ".evsm";
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+
+  // make sure to always use the same decimal point separator
+  std::setlocale(LC_ALL, "C");
+  std::locale::global(std::locale::classic());
+
+  Arguments args;
+  if (!parseArguments(argc, argv, args)) {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  World world;
+  world.setNumThreads(args.threads);
+  world.setPublishSnapshots(false);
+  world.setCheckpointKeyframeInterval(args.keyframe_every);
+  world.setSeed(args.seed);
+  world.setErosionSolver(args.erosion);
+  world.init();
+  const erosion::Stats& erosion = world.getErosionStats();
+  if (args.erosion == erosion::SHALLOW_WATER_SOLVER) {
+    printf("Eroded the terrain with %zu water steps in %.3f s (%.3e cell updates/s).\n",
+           erosion.num_steps,
+           erosion.duration,
+           erosion.getCellUpdatesPerSecond());
+  } else {
+    printf("Eroded the terrain with %zu droplets in %.3f s (%.3e droplets/s).\n",
+           erosion.num_droplets,
+           erosion.duration,
+           erosion.getDropletsPerSecond());
+  }
+  printBiomes(world.getBiomes());
+  if (args.presimulate_days > 0.) {
+    PresimulationSettings settings;
+    settings.max_duration = args.presimulate_days * 86400.;
+    const std::string file = args.snapshot_prefix + "_settled.evsm";
+    const PresimulationStats presimulation = world.presimulate(settings, file);
+    printf("Presimulated %.1f days in %.3f s, residuals %.3e m and %.3e K.\n",
+           presimulation.simulated_time / 86400.,
+           presimulation.duration,
+           presimulation.residuals.height,
+           presimulation.residuals.temperature);
+    if (presimulation.saved) {
+      printf("The world settled, saved %s.\n", file.c_str());
+    } else if (presimulation.settled) {
+      fprintf(stderr, "The world settled, failed to save %s\n", file.c_str());
+    } else {
+      printf("The world did not settle.\n");
+    }
+  }
+  printf("Simulating %llu ticks on %u threads.\n", args.ticks, world.getNumThreads());
+
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned long long t = 1; t <= args.ticks; t++) {
+    if (args.snapshot_every != 0 && t % args.snapshot_every == 0) {
+      // Only blocks if writing the last snapshot took longer than snapshot_every ticks.
+      // Otherwise the freeze would be delayed and the file name would not match its tick.
+      world.waitForCheckpoint();
+      world.requestCheckpoint(getSnapshotFile(args, t));
+    }
+    world.update();
+  }
+  const std::chrono::duration<double> passed = std::chrono::steady_clock::now() - start;
+  printf("Simulated %llu ticks in %.3f s (%.1f ticks/s).\n",
+         args.ticks,
+         passed.count(),
+         static_cast<double>(args.ticks) / passed.count());
+  printf("%zu plants and %zu creatures alive.\n",
+         world.getPlants().size(),
+         world.getCreatures().size());
+
+  world.waitForCheckpoint();
+  bool success = true;
+  if (args.snapshot_every == 0 || args.ticks % args.snapshot_every != 0) {
+    const std::string file = getSnapshotFile(args, world.getTick());
+    success = world.save(file);
+    if (!success) {
+      fprintf(stderr, "Failed to save snapshot %s\n", file.c_str());
+    }
+  }
+
+  const CheckpointStats stats = world.getCheckpointStats();
+  if (stats.num_written + stats.num_failed > 0) {
+    printf("Wrote %llu checkpoints (%llu deltas) in the background, %llu failed, "
+           "last took %.3f s.\n",
+           static_cast<unsigned long long>(stats.num_written),
+           static_cast<unsigned long long>(stats.num_deltas),
+           static_cast<unsigned long long>(stats.num_failed),
+           stats.last_write_duration);
+    printf("Wrote %.1f MiB, full files would have been %.1f MiB.\n",
+           static_cast<double>(stats.bytes_written) / (1 << 20),
+           static_cast<double>(stats.bytes_full) / (1 << 20));
+    printf("Mean tick %.3f ms idle, %.3f ms (max %.3f ms) while checkpointing: %+.1f%%.\n",
+           stats.mean_tick_duration_idle * 1e3,
+           stats.mean_tick_duration_checkpointing * 1e3,
+           stats.max_tick_duration_checkpointing * 1e3,
+           stats.getTickLatencyImpact() * 100.);
+  }
+  success &= stats.num_failed == 0;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
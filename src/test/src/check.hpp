@@ -0,0 +1,16 @@
+#ifndef TEST_CHECK
+#define TEST_CHECK
+
+#include <cstdio>
+#include <cstdlib>
+
+// Ends the test with a failure if condition is false.
+#define CHECK(condition)                                                             \
+  do {                                                                               \
+    if (!(condition)) {                                                              \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      std::exit(EXIT_FAILURE);                                                       \
+    }                                                                                \
+  } while (0)
+
+#endif
@@ -0,0 +1,48 @@
+#include <world/checkpointer.h>
+#include <world/worldFile.h>
+
+#include <filesystem>
+#include <string>
+
+#include "check.hpp"
+
+// An interval above MAX_DELTA_CHAIN must not write a chain which can not be loaded.
+void testLongKeyframeIntervalLoads() {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "evosym_test_checkpointer";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  const size_t num_cells = 16;
+  const size_t num_checkpoints = world_file::MAX_DELTA_CHAIN + 2;
+  std::string last_file;
+  {
+    Checkpointer checkpointer;
+    checkpointer.setKeyframeInterval(100000);
+    for (size_t i = 0; i < num_checkpoints; i++) {
+      CellGrid& frozen = checkpointer.beginFreeze(num_cells);
+      frozen.fill(AIR, TEMPERATURE, static_cast<double>(i));
+      world_file::WorldInfo info;
+      info.tick = i;
+      last_file = (directory / ("checkpoint_" + std::to_string(i) + ".evsm")).string();
+      checkpointer.commitFreeze(last_file, info);
+      checkpointer.waitUntilIdle();
+    }
+    const CheckpointStats stats = checkpointer.getStats();
+    CHECK(stats.num_failed == 0);
+    CHECK(stats.num_deltas > 0);
+    CHECK(stats.num_deltas < num_checkpoints - 1);
+  }
+
+  CellGrid grid;
+  world_file::WorldInfo info;
+  CHECK(world_file::load(last_file, grid, info));
+  CHECK(info.tick == num_checkpoints - 1);
+  CHECK(grid.getField(AIR, TEMPERATURE)[num_cells - 1] == static_cast<double>(num_checkpoints - 1));
+  std::filesystem::remove_all(directory);
+}
+
+int main() {
+  testLongKeyframeIntervalLoads();
+  return 0;
+}
@@ -0,0 +1,31 @@
+#include <world/cellGrid.h>
+#include <world/plant.h>
+
+#include <utils/taskScheduler.hpp>
+
+#include "check.hpp"
+
+// After resize() an update() must not replay the births and deaths of the plants before.
+void testResizeForgetsOldChanges() {
+  const size_t num_cells = 4096;
+  CellGrid grid(num_cells);
+  grid.fill(GROUND, TEMPERATURE, 293.15);
+  utils::TaskScheduler scheduler(2);
+  PlantPopulation plants;
+  plants.resize(num_cells);
+  plants.sow(100000, 1);
+  // long steps such that many plants seed and die
+  for (uint64_t tick = 1; tick <= 20; tick++) {
+    plants.update(1e4, grid, scheduler, tick);
+  }
+
+  plants.resize(num_cells);
+  plants.sow(10, 2);
+  plants.update(1., grid, scheduler, 21);
+  CHECK(plants.size() == 10);
+}
+
+int main() {
+  testResizeForgetsOldChanges();
+  return 0;
+}
@@ -0,0 +1,143 @@
+#include <world/cellGrid.h>
+#include <world/world.h>
+#include <world/worldFile.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <set>
+#include <vector>
+
+#include "check.hpp"
+
+// A new world changes with every update(), even without presimulate().
+void testFreshWorldChanges() {
+  World world;
+  world.setPublishSnapshots(false);
+  world.init();
+  const CellGrid before = world.getGrid();
+  world.update();
+  const CellGrid& after = world.getGrid();
+  CHECK(after.getNumCells() == before.getNumCells());
+  CHECK(std::memcmp(after.data(), before.data(), before.getSizeBytes()) != 0);
+}
+
+double toSeconds(tool::PreciseTime time) { return std::chrono::duration<double>(time).count(); }
+
+// Every tile sets its own update intervall, a tile is only updated once it passed.
+// The change step() returns bounds the largest one tightly.
+void testStepReturnsLargestChange() {
+  CellGrid grid;
+  grid.resize(37);
+  for (int l = 0; l < NUM_LAYER_TYPES; l++) {
+    for (int f = 0; f < NUM_GRID_FIELDS; f++) {
+      grid.fill(static_cast<LayerTyp>(l), static_cast<GridField>(f), 0.);
+    }
+  }
+  grid.fill(AIR, TEMPERATURE, 300.);
+  grid.fill(WATER, TEMPERATURE, 300.);
+  grid.fill(GROUND, TEMPERATURE, 300.);
+  grid.getField(GROUND, TEMPERATURE)[23] = 310.;
+  const double dt = 60.;
+  const double expected = 10. * dt / (CellGrid::AIR_HEAT_EXCHANGE_TIME + dt);
+  const double change = grid.step(dt);
+  CHECK(change >= expected);
+  CHECK(change <= expected * (1. + 1e-6));
+}
+
+void testSlowTilesAreSkipped() {
+  World world;
+  world.setPublishSnapshots(false);
+  world.init();
+  world.update();
+  const std::vector<GridTile>& tiles = world.getTiles();
+  std::vector<double> last_update(tiles.size());
+  std::vector<double> interval(tiles.size());
+  for (size_t i = 0; i < tiles.size(); i++) {
+    last_update[i] = toSeconds(tiles[i].getLastUpdateTime());
+    interval[i] = toSeconds(tiles[i].getUpdateIntervall());
+  }
+
+  size_t num_skipped = 0;
+  for (int t = 0; t < 256; t++) {
+    world.update();
+    // one second per tick
+    const double now = static_cast<double>(world.getTick());
+    for (size_t i = 0; i < tiles.size(); i++) {
+      const double update = toSeconds(tiles[i].getLastUpdateTime());
+      if (update == last_update[i]) {
+        CHECK(now - last_update[i] < interval[i]);
+        num_skipped++;
+      } else {
+        CHECK(update == now);
+        CHECK(now - last_update[i] >= interval[i] - 1e-6);
+        last_update[i] = update;
+        interval[i] = toSeconds(tiles[i].getUpdateIntervall());
+      }
+    }
+  }
+  CHECK(num_skipped > 0);
+  // The tiles change at different rates.
+  CHECK(std::set<double>(interval.begin(), interval.end()).size() > 1);
+}
+
+// Snapshots only copy the tiles which changed since their buffer was written, yet always
+// show the whole grid.
+void testSnapshotsMatchGrid() {
+  World world;
+  world.init();
+  for (int t = 0; t < 32; t++) {
+    world.update();
+    const WorldSnapshot& snapshot = world.readSnapshot();
+    CHECK(snapshot.tick == world.getTick());
+    // the const getGrid(), the other one marks all tiles as changed
+    const CellGrid& grid = static_cast<const World&>(world).getGrid();
+    for (int l = 0; l < NUM_LAYER_TYPES; l++) {
+      const LayerTyp layer = static_cast<LayerTyp>(l);
+      const double* temperature = grid.getField(layer, TEMPERATURE);
+      for (size_t c = 0; c < grid.getNumCells(); c++) {
+        CHECK(snapshot.temperature[l][c] == static_cast<float>(temperature[c]));
+      }
+    }
+  }
+}
+
+// A synchronous save() replaces a file the background checkpoints may depend on, the next
+// checkpoint must still load.
+void testCheckpointAfterSaveLoads() {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "evosym_test_world";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  const std::string file_a = (directory / "a.evsm").string();
+  const std::string file_b = (directory / "b.evsm").string();
+
+  World world;
+  world.setPublishSnapshots(false);
+  world.setCheckpointKeyframeInterval(8);
+  world.init();
+  world.requestCheckpoint(file_a);
+  world.update();
+  world.waitForCheckpoint();
+  // a different tick than the checkpoint
+  world.update();
+  CHECK(world.save(file_a));
+  world.requestCheckpoint(file_b);
+  world.update();
+  world.waitForCheckpoint();
+
+  CellGrid grid;
+  world_file::WorldInfo info;
+  CHECK(world_file::load(file_b, grid, info));
+  CHECK(info.tick == world.getTick());
+  std::filesystem::remove_all(directory);
+}
+
+int main() {
+  testFreshWorldChanges();
+  testStepReturnsLargestChange();
+  testSlowTilesAreSkipped();
+  testSnapshotsMatchGrid();
+  testCheckpointAfterSaveLoads();
+  return 0;
+}
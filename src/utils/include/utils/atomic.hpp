@@ -0,0 +1,36 @@
+#ifndef ATOMIC_UTILS
+#define ATOMIC_UTILS
+
+#include <type_traits>
+
+namespace utils {
+
+// Atomic access to plain values (e.g. the doubles of a CellGrid) which are only shared by
+// threads during a few phases. Between these phases the values are used without the cost
+// of std::atomic. Relaxed: only the value itself is synchronized, not the memory around.
+
+template <class T>
+inline T atomicLoad(const T* value) {
+  static_assert(std::is_trivially_copyable<T>::value, "atomicLoad needs a plain value");
+  T result;
+  __atomic_load(value, &result, __ATOMIC_RELAXED);
+  return result;
+}
+
+/*!
+ * \brief Adds to value with a compare and swap loop: concurrent adds to the same value are
+ * all applied, in an unspecified order.
+ */
+template <class T>
+inline void atomicAdd(T* value, T summand) {
+  static_assert(std::is_floating_point<T>::value, "integers have __atomic_fetch_add");
+  T expected = atomicLoad(value);
+  T desired = expected + summand;
+  while (!__atomic_compare_exchange(
+      value, &expected, &desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    desired = expected + summand;
+  }
+}
+}  // namespace utils
+
+#endif
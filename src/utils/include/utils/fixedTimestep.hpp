@@ -0,0 +1,91 @@
+#ifndef FIXED_TIMESTEP
+#define FIXED_TIMESTEP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace utils {
+
+/*!
+ * \brief Calls a step function at a fixed rate. Between two steps the calling thread sleeps
+ * instead of spinning. If steps take longer than the period, up to MAX_CATCH_UP steps run
+ * back to back, after that the backlog is dropped: a slow simulation runs slower instead of
+ * falling further and further behind.
+ * A period of 0 is the batch mode: steps run back to back as fast as possible.
+ */
+class FixedTimestep {
+ public:
+  /*!
+   * \brief Constructor
+   * \param period [s] The time between two steps, 0 for batch mode.
+   */
+  explicit FixedTimestep(double period = 0.) : period(period) {}
+
+  /*!
+   * \brief Thread safe, takes effect with the next step.
+   * \param period [s] The time between two steps, 0 for batch mode.
+   */
+  void setPeriod(double period) { this->period = std::max(period, 0.); }
+
+  double getPeriod() const { return period.load(); }
+
+  bool isBatchMode() const { return period.load() <= 0.; }
+
+  /*!
+   * \brief Thread safe. The number of steps which were skipped since the steps took too long.
+   */
+  uint64_t getNumDroppedSteps() const { return num_dropped_steps.load(); }
+
+  /*!
+   * \brief Calls step() until stop is set. Returns at latest MAX_SLEEP after stop was set.
+   * \param stop Set from another thread to end the loop.
+   * \param step Called once per time step.
+   */
+  template <class Step>
+  void run(const std::atomic<bool>& stop, Step&& step) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point next = Clock::now();
+    unsigned int num_behind = 0;
+    while (!stop) {
+      const double p = period.load();
+      if (p <= 0.) {
+        step();
+        next = Clock::now();
+        continue;
+      }
+
+      const Clock::time_point now = Clock::now();
+      if (now < next) {
+        // Sleep in slices to notice stop.
+        std::this_thread::sleep_until(std::min(next, now + MAX_SLEEP));
+        continue;
+      }
+
+      step();
+      const Clock::duration period_duration =
+          std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(p));
+      next += period_duration;
+      const Clock::time_point after = Clock::now();
+      if (after < next) {
+        num_behind = 0;
+      } else if (++num_behind > MAX_CATCH_UP) {
+        num_dropped_steps += static_cast<uint64_t>((after - next) / period_duration) + 1;
+        next = after;
+        num_behind = 0;
+      }
+    }
+  }
+
+ private:
+  std::atomic<double> period;
+  std::atomic<uint64_t> num_dropped_steps{0};
+
+  static constexpr unsigned int MAX_CATCH_UP = 5;
+  static constexpr std::chrono::milliseconds MAX_SLEEP{50};
+};
+}  // namespace utils
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef HANDLE_POOL
+#define HANDLE_POOL
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace utils {
+
+/*!
+ * \brief Refers to one slot of a HandlePool. Stays valid until the slot is destroyed,
+ * a later object in the same slot has another generation.
+ */
+struct Handle {
+  uint32_t index = std::numeric_limits<uint32_t>::max();
+  uint32_t generation = 0;
+
+  bool operator==(const Handle& other) const {
+    return index == other.index && generation == other.generation;
+  }
+  bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+/*!
+ * \brief Hands out stable slot indices with generational handles. The owner keeps its data
+ * in arrays indexed by slot (structure of arrays) which only grow, freed slots are reused
+ * before the arrays grow. Thus a population of constant size does not allocate.
+ */
+class HandlePool {
+ public:
+  void reserve(size_t num_slots) {
+    generations.reserve(num_slots);
+    free_slots.reserve(num_slots);
+  }
+
+  /*!
+   * \brief Occupies a slot, the last freed one if there is one.
+   * \return The handle of the slot. Its index might be getNumSlots() - 1 of a new slot.
+   */
+  Handle create() {
+    Handle handle;
+    if (free_slots.empty()) {
+      handle.index = static_cast<uint32_t>(generations.size());
+      generations.push_back(1);
+    } else {
+      handle.index = free_slots.back();
+      free_slots.pop_back();
+      generations[handle.index]++;
+    }
+    handle.generation = generations[handle.index];
+    num_alive++;
+    return handle;
+  }
+
+  /*!
+   * \brief Frees the slot of the handle.
+   * \return False if the handle was already destroyed.
+   */
+  bool destroy(const Handle& handle) {
+    if (!isAlive(handle)) {
+      return false;
+    }
+    generations[handle.index]++;
+    free_slots.push_back(handle.index);
+    num_alive--;
+    return true;
+  }
+
+  bool isAlive(const Handle& handle) const {
+    return handle.index < generations.size() && generations[handle.index] == handle.generation &&
+           isAlive(handle.index);
+  }
+
+  /*!
+   * \brief True if the slot is occupied. Used to iterate over all slots.
+   */
+  bool isAlive(uint32_t index) const { return (generations[index] & 1u) != 0; }
+
+  /*!
+   * \brief The handle of an occupied slot.
+   */
+  Handle getHandle(uint32_t index) const { return Handle{index, generations[index]}; }
+
+  void clear() {
+    generations.clear();
+    free_slots.clear();
+    num_alive = 0;
+  }
+
+  /*!
+   * \brief The number of occupied slots.
+   */
+  size_t size() const { return num_alive; }
+
+  /*!
+   * \brief The number of occupied and free slots, valid indices are [0, getNumSlots()).
+   */
+  size_t getNumSlots() const { return generations.size(); }
+
+ private:
+  // odd: occupied, even: free
+  std::vector<uint32_t> generations;
+  std::vector<uint32_t> free_slots;
+  size_t num_alive = 0;
+};
+}  // namespace utils
+
+#endif
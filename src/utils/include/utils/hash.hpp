@@ -0,0 +1,28 @@
+#ifndef HASH
+#define HASH
+
+#include <cstdint>
+
+namespace utils {
+
+/*!
+ * \brief splitmix64 finalizer: a stateless random number generator. Hashing
+ * (seed, index) gives every element its own numbers, independent of the order or
+ * thread it is processed in.
+ */
+inline uint64_t hash(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+/*!
+ * \brief Maps a random number to [0, 1).
+ */
+inline float toUnitFloat(uint64_t random) {
+  return static_cast<float>(random >> 40) * (1.f / (1 << 24));
+}
+}  // namespace utils
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef ICOSPHERE
+#define ICOSPHERE
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace utils {
+
+/*!
+ * \brief A unit icosphere: an icosahedron whose triangles are split into 4 per level, the new
+ * vertices are projected onto the sphere. All triangles share their vertices.
+ * Besides the triangles every level keeps its edges and which edges each triangle has. Edge e
+ * gets the midpoint vertex getNumVertices() + e and splits into the edges 2e and 2e + 1, thus
+ * the next level is pure index arithmetic without searching shared edges.
+ */
+struct IcosphereLevel {
+  // unit length
+  std::vector<Eigen::Vector3f> positions;
+  // per vertex: longitude and latitude mapped to [0, 1], see getTextureCoordinates()
+  std::vector<std::array<float, 2>> texture_coordinates;
+  // counterclockwise seen from outside
+  std::vector<std::array<uint32_t, 3>> triangles;
+  // the vertices of the edges
+  std::vector<std::array<uint32_t, 2>> edges;
+  // per triangle: the edges from its vertex k to its vertex (k + 1) % 3
+  std::vector<std::array<uint32_t, 3>> triangle_edges;
+
+  size_t getNumVertices() const { return positions.size(); }
+
+  static std::array<float, 2> getTextureCoordinates(const Eigen::Vector3f& position) {
+    constexpr float PI = 3.14159265358979f;
+    return {0.5f + std::atan2(position.y(), position.x()) / (2.f * PI),
+            0.5f + std::asin(std::max(-1.f, std::min(1.f, position.z()))) / PI};
+  }
+
+  /*!
+   * \brief The number of vertices of a level without building it.
+   */
+  static size_t getNumVertices(unsigned int level) {
+    return 10 * (size_t(1) << (2 * level)) + 2;
+  }
+
+  /*!
+   * \brief The number of triangles of a level without building it.
+   */
+  static size_t getNumTriangles(unsigned int level) { return 20 * (size_t(1) << (2 * level)); }
+
+  /*!
+   * \brief Level 0, the icosahedron.
+   */
+  static IcosphereLevel icosahedron() {
+    IcosphereLevel ico;
+    const float t = (1.f + std::sqrt(5.f)) / 2.f;
+    // clang-format off
+    const float corners[12][3] = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+                                  {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+                                  {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+    ico.triangles = {{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+                     {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+                     {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+                     {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+    // clang-format on
+    for (const auto& corner : corners) {
+      ico.positions.emplace_back(Eigen::Vector3f(corner[0], corner[1], corner[2]).normalized());
+      ico.texture_coordinates.emplace_back(getTextureCoordinates(ico.positions.back()));
+    }
+
+    // Every edge is shared by two triangles, the second one finds it among the first's.
+    ico.triangle_edges.resize(ico.triangles.size());
+    for (size_t t = 0; t < ico.triangles.size(); t++) {
+      for (int k = 0; k < 3; k++) {
+        const uint32_t a = ico.triangles[t][k];
+        const uint32_t b = ico.triangles[t][(k + 1) % 3];
+        uint32_t e = 0;
+        while (e < ico.edges.size() && !(ico.edges[e][0] == b && ico.edges[e][1] == a)) {
+          e++;
+        }
+        if (e == ico.edges.size()) {
+          ico.edges.push_back({a, b});
+        }
+        ico.triangle_edges[t][k] = e;
+      }
+    }
+    return ico;
+  }
+
+  /*!
+   * \brief Splits every triangle into 4.
+   */
+  IcosphereLevel subdivide() const {
+    IcosphereLevel next;
+    const uint32_t num_vertices = static_cast<uint32_t>(positions.size());
+    const uint32_t num_edges = static_cast<uint32_t>(edges.size());
+
+    next.positions.resize(positions.size() + edges.size());
+    std::copy(positions.begin(), positions.end(), next.positions.begin());
+    next.texture_coordinates.resize(positions.size() + edges.size());
+    std::copy(texture_coordinates.begin(),
+              texture_coordinates.end(),
+              next.texture_coordinates.begin());
+    next.edges.resize(2 * edges.size() + 3 * triangles.size());
+    for (uint32_t e = 0; e < num_edges; e++) {
+      const uint32_t midpoint = num_vertices + e;
+      next.positions[midpoint] = (positions[edges[e][0]] + positions[edges[e][1]]).normalized();
+      next.texture_coordinates[midpoint] = getTextureCoordinates(next.positions[midpoint]);
+      next.edges[2 * e] = {edges[e][0], midpoint};
+      next.edges[2 * e + 1] = {midpoint, edges[e][1]};
+    }
+
+    next.triangles.resize(4 * triangles.size());
+    next.triangle_edges.resize(4 * triangles.size());
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+      const std::array<uint32_t, 3>& v = triangles[t];
+      const std::array<uint32_t, 3>& e = triangle_edges[t];
+      const uint32_t m[3] = {num_vertices + e[0], num_vertices + e[1], num_vertices + e[2]};
+      // half of the edge k of the triangle which touches vertex
+      const auto half = [this, &e](int k, uint32_t vertex) {
+        return (edges[e[k]][0] == vertex) ? 2 * e[k] : 2 * e[k] + 1;
+      };
+      // the inner edges m0 -> m1, m1 -> m2, m2 -> m0
+      const uint32_t inner = 2 * num_edges + 3 * t;
+      next.edges[inner] = {m[0], m[1]};
+      next.edges[inner + 1] = {m[1], m[2]};
+      next.edges[inner + 2] = {m[2], m[0]};
+
+      const uint32_t c = 4 * t;
+      next.triangles[c] = {v[0], m[0], m[2]};
+      next.triangle_edges[c] = {half(0, v[0]), inner + 2, half(2, v[0])};
+      next.triangles[c + 1] = {m[0], v[1], m[1]};
+      next.triangle_edges[c + 1] = {half(0, v[1]), half(1, v[1]), inner};
+      next.triangles[c + 2] = {m[2], m[1], v[2]};
+      next.triangle_edges[c + 2] = {inner + 1, half(1, v[2]), half(2, v[2])};
+      next.triangles[c + 3] = {m[0], m[1], m[2]};
+      next.triangle_edges[c + 3] = {inner, inner + 1, inner + 2};
+    }
+    return next;
+  }
+
+  /*!
+   * \brief The level, built on first use from the next lower one and cached for the rest of
+   * the program. Thread safe, the returned level never changes or moves.
+   */
+  static const IcosphereLevel& get(unsigned int level) {
+    static std::mutex mutex;
+    static std::deque<IcosphereLevel> levels;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (levels.empty()) {
+      levels.emplace_back(icosahedron());
+    }
+    while (levels.size() <= level) {
+      levels.emplace_back(levels.back().subdivide());
+    }
+    return levels[level];
+  }
+};
+}  // namespace utils
+
+#endif
@@ -3,9 +3,11 @@
 
 #include <Eigen/Geometry>
 #include <algorithm>
+#include <array>
 #include <iostream>
 #include <limits>
 #include <utility>
+#include <vector>
 
 #include "eigen_conversations.hpp"
 
@@ -19,10 +21,10 @@ class MinMax {
 
   /*!
    * \brief Default constructor will initiate the stored boundaries
-   * to the double limits max/min possible.
+   * to the limits lowest/max possible.
    */
   MinMax() {
-    min = std::numeric_limits<T>::min();
+    min = std::numeric_limits<T>::lowest();
     max = std::numeric_limits<T>::max();
   }
 
@@ -73,7 +75,7 @@ class MinMax {
    * \return True if at least one stored value is not the default value (limit).
    */
   bool isInitiated() const {
-    return (min != std::numeric_limits<T>::min() || max != std::numeric_limits<T>::max())
+    return (min != std::numeric_limits<T>::lowest() || max != std::numeric_limits<T>::max())
                ? true
                : false;
   }
@@ -98,7 +100,7 @@ class MinMax {
    * this->min.
    * \return if the given value is below max value.
    */
-  bool setMin(double min) {
+  bool setMin(T min) {
     if (min <= max) {
       this->min = min;
       return true;
@@ -147,7 +149,7 @@ class MinMax3d {
   MinMax<T> &y = data[1];
   MinMax<T> &z = data[2];
 
-  MinMax3d();
+  MinMax3d() = default;
 
   MinMax3d(const Eigen::Matrix<T, 3, 1> &min, const Eigen::Matrix<T, 3, 1> &max) {
     set(min, max);
@@ -165,11 +167,8 @@ class MinMax3d {
    * \return The copied MinMax3D class.
    */
   MinMax3d &operator=(const MinMax3d &minMax3d) {
-    if (this != &minMax3d) {
-      this->~MinMax3D();
-      new (this) MinMax(minMax3d);
-    }
-
+    // x, y and z keep referencing the own data
+    data = minMax3d.data;
     return *this;
   }
 
@@ -245,26 +244,24 @@ class MinMax3d {
                                std::numeric_limits<T>::max(),
                                std::numeric_limits<T>::max());
     Eigen::Matrix<T, 3, 1> max =
-        Eigen::Matrix<T, 3, 1>(std::numeric_limits<T>::min(),
-                               std::numeric_limits<T>::min(),
-                               std::numeric_limits<T>::min());
+        Eigen::Matrix<T, 3, 1>(std::numeric_limits<T>::lowest(),
+                               std::numeric_limits<T>::lowest(),
+                               std::numeric_limits<T>::lowest());
 
     for (const auto &p : points) {
-      for (int i = 0; i < 3; i++) {
-        min(i, 1) = std::min(min(i, 1), p(i, 1));
-        max(i, 1) = std::max(max(i, 1), p(i, 1));
-      }
+      min = min.cwiseMin(p);
+      max = max.cwiseMax(p);
     }
+    // no points: set() swaps the limits into the uninitialized state
     set(min, max);
   }
 
   /*!
-   * \brief Writes into a given vector all 8 Corner points of this MinMax3d
-   * cube.
+   * \brief Appends all 8 Corner points of this MinMax3d cube to a given vector.
    * \param corners The vector to be written into.
    */
   void getCornerPositions(
-      std::vector<Eigen::Matrix<T, 3, 1>, Eigen::aligned_allocator<Eigen::Matrix<T, 3, 1>>> corners) const {
+      std::vector<Eigen::Matrix<T, 3, 1>, Eigen::aligned_allocator<Eigen::Matrix<T, 3, 1>>> &corners) const {
     corners.push_back(Eigen::Matrix<T, 3, 1>(x.min, y.min, z.min));
     corners.push_back(Eigen::Matrix<T, 3, 1>(x.max, y.min, z.min));
     corners.push_back(Eigen::Matrix<T, 3, 1>(x.min, y.max, z.min));
@@ -282,11 +279,12 @@ class MinMax3d {
    * \param min_max_3d The cube which should fit inside this MinMax3d cube.
    */
   void fitOutside(const Eigen::Transform<T, 3, Eigen::Isometry> &isometry,
-                  const MinMax3d min_max_3d) {
+                  const MinMax3d &min_max_3d) {
     if (!min_max_3d.isInitiated()) {
       return;
     }
-    std::vector<Eigen::Matrix<T, 3, 1>, Eigen::aligned_allocator<Eigen::Matrix<T, 3, 1>>> corners(8);
+    std::vector<Eigen::Matrix<T, 3, 1>, Eigen::aligned_allocator<Eigen::Matrix<T, 3, 1>>> corners;
+    corners.reserve(8);
     min_max_3d.getCornerPositions(corners);
     for (auto &p : corners) {
       p = isometry * p;
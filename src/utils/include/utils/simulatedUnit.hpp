@@ -21,8 +21,9 @@ class SimulatedUnit {
   /*!
    * \brief default constructor
    */
-  SimulatedUnit(tool::PreciseTime t0) : t0(t0) {}
-  ~SimulatedUnit() {}
+  SimulatedUnit(tool::PreciseTime t0)
+      : t0(t0), t_last_update(t0), delta_t_update(), has_updated(false) {}
+  virtual ~SimulatedUnit() {}
 
   /*!
    * \brief: To run one simulation step from a child class run this function.
@@ -48,6 +49,25 @@ class SimulatedUnit {
    */
   tool::PreciseTime getAge() { return getAge(t_last_update); }
 
+  /*!
+   * \brief The earliest time simulate() will update this unit again. A scheduler only
+   * needs to call simulate() from then on, e.g. see utils::TimingWheel.
+   * \return The time of the last update plus the update intervall.
+   */
+  tool::PreciseTime getNextUpdateTime() const { return t_last_update + delta_t_update; }
+
+  tool::PreciseTime getUpdateIntervall() const { return delta_t_update; }
+
+  tool::PreciseTime getLastUpdateTime() const { return t_last_update; }
+
+  /*!
+   * \brief Sets after which intervall this unit needs an update.
+   * \param delta_t_update 0 means every simulation step.
+   */
+  void setUpdateIntervall(tool::PreciseTime delta_t_update) {
+    this->delta_t_update = delta_t_update;
+  }
+
   /*!
    * \brief Checks, if this simulated unit was updated since the last time
    * asked. E.g. for redrawing purpose. \return True if the unit was updated.
@@ -0,0 +1,180 @@
+#ifndef TASK_SCHEDULER
+#define TASK_SCHEDULER
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+/*!
+ * \brief A pool of worker threads with one task queue per thread.
+ * A thread works its own queue from the back and steals from the front of
+ * the other queues once its own queue is empty.
+ */
+class TaskScheduler {
+ public:
+  typedef std::function<void(size_t)> IndexedTask;
+
+  /*!
+   * \brief Constructor
+   * \param num_threads The number of threads which work on tasks, including the
+   * thread calling parallelFor(). 0 means one thread per hardware core.
+   */
+  explicit TaskScheduler(unsigned int num_threads = 0) {
+    if (num_threads == 0) {
+      num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    queues.reserve(num_threads);
+    for (unsigned int i = 0; i < num_threads; i++) {
+      queues.emplace_back(std::make_unique<WorkQueue>());
+    }
+    workers.reserve(num_threads - 1);
+    for (unsigned int i = 1; i < num_threads; i++) {
+      workers.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+  }
+
+  ~TaskScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    wake_workers.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  unsigned int getNumThreads() const {
+    return static_cast<unsigned int>(queues.size());
+  }
+
+  /*!
+   * \brief Calls task(i) for every i in [0, num_tasks) distributed over all threads.
+   * Returns after all calls have finished, thus acts as a barrier.
+   * Must not be called concurrently or from within a task.
+   * \param num_tasks The number of tasks.
+   * \param task The function to be called with the task index.
+   */
+  void parallelFor(size_t num_tasks, const IndexedTask &task) {
+    if (num_tasks == 0) {
+      return;
+    }
+    if (queues.size() == 1) {
+      for (size_t i = 0; i < num_tasks; i++) {
+        task(i);
+      }
+      return;
+    }
+
+    remaining_tasks.store(num_tasks);
+    // Give each thread a contiguous block of tasks, neighbouring tasks
+    // often share memory.
+    const size_t num_queues = queues.size();
+    for (size_t q = 0; q < num_queues; q++) {
+      const size_t begin = num_tasks * q / num_queues;
+      const size_t end = num_tasks * (q + 1) / num_queues;
+      std::lock_guard<std::mutex> lock(queues[q]->mutex);
+      for (size_t i = begin; i < end; i++) {
+        queues[q]->tasks.push_back({&task, i});
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      generation++;
+    }
+    wake_workers.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [this] { return remaining_tasks.load() == 0; });
+  }
+
+ private:
+  struct Task {
+    const IndexedTask *function;
+    size_t index;
+  };
+
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void workerLoop(unsigned int id) {
+    uint64_t seen_generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake_workers.wait(
+            lock, [this, seen_generation] { return stop || generation != seen_generation; });
+        if (stop) {
+          return;
+        }
+        seen_generation = generation;
+      }
+      runTasks(id);
+    }
+  }
+
+  void runTasks(unsigned int id) {
+    Task task;
+    while (popOwn(id, task) || steal(id, task)) {
+      (*task.function)(task.index);
+      if (remaining_tasks.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        all_done.notify_all();
+      }
+    }
+  }
+
+  bool popOwn(unsigned int id, Task &task) {
+    WorkQueue &queue = *queues[id];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      return false;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+  }
+
+  bool steal(unsigned int thief_id, Task &task) {
+    const size_t num_queues = queues.size();
+    for (size_t i = 1; i < num_queues; i++) {
+      WorkQueue &victim = *queues[(thief_id + i) % num_queues];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable wake_workers;
+  std::condition_variable all_done;
+  uint64_t generation = 0;
+  bool stop = false;
+  std::atomic<size_t> remaining_tasks{0};
+};
+}  // namespace utils
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef TIMING_WHEEL
+#define TIMING_WHEEL
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace utils {
+
+/*!
+ * \brief Hierarchical timing wheel: schedules items for an integer tick and returns the
+ * items due at a tick without looking at the items which are not due.
+ *
+ * Level l has SLOTS slots of SLOTS^l ticks each. An item is stored in the lowest level
+ * whose range covers its due tick. Whenever a level l slot starts, its items move down
+ * to lower levels (cascade). Schedule and advance cost O(1) amortized per item, no
+ * matter how many items wait for later ticks. Items further away than the range of all
+ * levels are parked in the last level and rescheduled when reached.
+ */
+template <class T>
+class TimingWheel {
+ public:
+  /*!
+   * \brief Constructor
+   * \param tick The current tick, the first advance() returns the items due at tick + 1.
+   */
+  explicit TimingWheel(uint64_t tick = 0) : now(tick) {}
+
+  /*!
+   * \brief Removes all items and restarts at the given tick.
+   */
+  void reset(uint64_t tick) {
+    for (auto& level : levels) {
+      for (auto& slot : level) {
+        slot.clear();
+      }
+    }
+    now = tick;
+    num_items = 0;
+  }
+
+  /*!
+   * \brief Schedules the item.
+   * \param item The item to be returned by advance().
+   * \param due_tick The tick the item is due. Ticks <= getTick() are due with the next advance().
+   */
+  void schedule(const T& item, uint64_t due_tick) {
+    insert(Entry{item, std::max(due_tick, now + 1)});
+    num_items++;
+  }
+
+  /*!
+   * \brief Moves to the next tick.
+   * \param due Receives the items due at the new tick, in no particular order. Every item
+   * is returned once, reschedule it to get it again.
+   */
+  void advance(std::vector<T>& due) {
+    now++;
+    // Slots of higher levels start only together with slots of all lower levels.
+    int highest = 0;
+    while (highest + 1 < NUM_LEVELS && (now & getLevelMask(highest + 1)) == 0) {
+      highest++;
+    }
+    for (int l = highest; l > 0; l--) {
+      cascade(l);
+    }
+
+    std::vector<Entry>& slot = levels[0][now & MASK];
+    pending.swap(slot);
+    for (const Entry& entry : pending) {
+      if (entry.due_tick == now) {
+        due.push_back(entry.item);
+        num_items--;
+      } else {
+        // parked beyond the range of the wheel
+        insert(entry);
+      }
+    }
+    pending.clear();
+  }
+
+  uint64_t getTick() const { return now; }
+
+  size_t size() const { return num_items; }
+
+ private:
+  struct Entry {
+    T item;
+    uint64_t due_tick;
+  };
+
+  static constexpr int BITS = 6;
+  static constexpr uint64_t SLOTS = uint64_t(1) << BITS;
+  static constexpr uint64_t MASK = SLOTS - 1;
+  static constexpr int NUM_LEVELS = 4;
+  // The farthest tick an item can be placed at directly.
+  static constexpr uint64_t MAX_DELTA = (uint64_t(1) << (BITS * NUM_LEVELS)) - 1;
+
+  // The bits of the tick below the slots of the given level.
+  static constexpr uint64_t getLevelMask(int level) {
+    return (uint64_t(1) << (BITS * level)) - 1;
+  }
+
+  void insert(const Entry& entry) {
+    // Place far away items at the end of the range, advance() inserts them again.
+    const uint64_t place = std::min(entry.due_tick, now + MAX_DELTA);
+    const uint64_t delta = place - now;
+    int l = 0;
+    while (l + 1 < NUM_LEVELS && delta > getLevelMask(l + 1)) {
+      l++;
+    }
+    levels[l][(place >> (BITS * l)) & MASK].push_back(entry);
+  }
+
+  void cascade(int level) {
+    std::vector<Entry>& slot = levels[level][(now >> (BITS * level)) & MASK];
+    pending.swap(slot);
+    for (const Entry& entry : pending) {
+      insert(entry);
+    }
+    pending.clear();
+  }
+
+  std::array<std::array<std::vector<Entry>, SLOTS>, NUM_LEVELS> levels;
+  // reused to empty a slot while inserting into the wheel
+  std::vector<Entry> pending;
+  uint64_t now;
+  size_t num_items = 0;
+};
+}  // namespace utils
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef TRIPLE_BUFFER
+#define TRIPLE_BUFFER
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace utils {
+
+/*!
+ * \brief Lock free exchange of data between exactly one producer thread and exactly one
+ * consumer thread. The producer always has a buffer to write into and the consumer always
+ * reads the latest complete buffer. Neither of them ever waits for the other.
+ * Usage producer: fill getWriteBuffer(), then publish().
+ * Usage consumer: read().
+ */
+template <class T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+  /*!
+   * \brief Producer only: The buffer to be written into. It is not visible to the
+   * consumer until publish() is called.
+   */
+  T &getWriteBuffer() { return buffers[write_index]; }
+
+  /*!
+   * \brief Producer only: Hands the write buffer to the consumer and takes the
+   * spare buffer as new write buffer.
+   */
+  void publish() {
+    const uint8_t old_spare = spare.exchange(write_index | NEW_DATA_FLAG, std::memory_order_acq_rel);
+    write_index = old_spare & INDEX_MASK;
+  }
+
+  /*!
+   * \brief Consumer only: Returns the latest published buffer. The returned reference
+   * stays valid and unchanged until the next call of read().
+   */
+  const T &read() {
+    if (hasNewData()) {
+      const uint8_t old_spare = spare.exchange(read_index, std::memory_order_acq_rel);
+      read_index = old_spare & INDEX_MASK;
+    }
+    return buffers[read_index];
+  }
+
+  /*!
+   * \brief Consumer only: True if read() would return a newer buffer than last time.
+   */
+  bool hasNewData() const {
+    return (spare.load(std::memory_order_acquire) & NEW_DATA_FLAG) != 0;
+  }
+
+ private:
+  static constexpr uint8_t INDEX_MASK = 0x3;
+  static constexpr uint8_t NEW_DATA_FLAG = 0x4;
+
+  std::array<T, 3> buffers;
+  uint8_t write_index = 0;
+  uint8_t read_index = 1;
+  // Index of the buffer which is neither written nor read plus NEW_DATA_FLAG
+  // if it was published but not yet read.
+  std::atomic<uint8_t> spare{2};
+};
+}  // namespace utils
+
+#endif
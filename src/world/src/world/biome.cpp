@@ -0,0 +1,110 @@
+#include "biome.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "gridGeometry.h"
+#include "noise.h"
+
+namespace {
+
+// By climate (cold, cool, temperate, warm) and moisture (dry, medium, wet).
+constexpr biome::Biome CLIMATE_BIOMES[4][3] = {
+    {biome::TUNDRA, biome::TUNDRA, biome::TUNDRA},
+    {biome::STEPPE, biome::TAIGA, biome::TAIGA},
+    {biome::DESERT, biome::STEPPE, biome::FOREST},
+    {biome::DESERT, biome::SAVANNA, biome::RAINFOREST}};
+
+constexpr float EROSION_STRENGTH[biome::NUM_BIOMES] = {
+    // OCEAN, LAKE, ICE, TUNDRA, TAIGA, STEPPE, FOREST, DESERT, SAVANNA, RAINFOREST, MOUNTAIN
+    0.f, 0.5f, 0.2f, 0.6f, 0.5f, 0.9f, 0.5f, 1.5f, 1.f, 0.7f, 0.3f};
+
+constexpr const char* NAMES[biome::NUM_BIOMES] = {"ocean",
+                                                   "lake",
+                                                   "ice",
+                                                   "tundra",
+                                                   "taiga",
+                                                   "steppe",
+                                                   "forest",
+                                                   "desert",
+                                                   "savanna",
+                                                   "rainforest",
+                                                   "mountain"};
+}  // namespace
+
+namespace biome {
+
+void classify(const CellGrid& grid,
+              uint64_t seed,
+              utils::TaskScheduler& scheduler,
+              uint8_t* biomes,
+              const Parameters& p) {
+  const size_t num_cells = grid.getNumCells();
+  const uint32_t num_grid_cells = static_cast<uint32_t>(num_cells);
+  const size_t rows = GridGeometry::getNumRows(num_grid_cells);
+  const size_t columns = GridGeometry::getNumColumns(num_grid_cells);
+  const double* ground = grid.getField(GROUND, HEIGHT);
+  const double* water = grid.getField(WATER, HEIGHT);
+  const double* temperature = grid.getField(AIR, TEMPERATURE);
+
+  // Spans a few regions per continent.
+  noise::Fractal fractal;
+  fractal.octaves = 4;
+  fractal.frequency = 3.f;
+  const uint32_t noise_seed = static_cast<uint32_t>(seed);
+  const size_t num_tasks = (num_cells + CELLS_PER_TASK - 1) / CELLS_PER_TASK;
+  scheduler.parallelFor(num_tasks, [&](size_t task) {
+    const size_t begin = task * CELLS_PER_TASK;
+    const size_t n = std::min(num_cells, begin + CELLS_PER_TASK) - begin;
+    std::vector<float> x(n);
+    std::vector<float> y(n);
+    std::vector<float> z(n);
+    std::vector<float> moisture(n);
+    GridGeometry::getCellCenters(begin, begin + n, num_grid_cells, x.data(), y.data(), z.data());
+    noise::fractal(n, x.data(), y.data(), z.data(), fractal, noise_seed, moisture.data());
+
+    size_t belt_row = rows;
+    float belt = 0.f;
+    for (size_t j = 0; j < n; j++) {
+      const size_t cell = begin + j;
+      const size_t row = std::min(rows - 1, cell / columns);
+      if (row != belt_row) {
+        // Rows are of equal height in z, the latitude of the row center.
+        const double latitude =
+            std::asin(2. * (static_cast<double>(row) + 0.5) / static_cast<double>(rows) - 1.);
+        // 1 at the equator and at +-60 degrees, 0 at +-30 degrees and at the poles
+        belt = static_cast<float>(0.5 + 0.5 * std::cos(6. * latitude));
+        belt_row = row;
+      }
+      const bool has_water = water[cell] > 0.;
+      const float m =
+          belt + p.moisture_noise * moisture[j] + (has_water ? p.water_moisture : 0.f);
+
+      const double t = temperature[cell];
+      const int climate = (t >= p.cold_temperature) + (t >= p.temperate_temperature) +
+                          (t >= p.warm_temperature);
+      const int wetness = (m >= p.dry_moisture) + (m >= p.wet_moisture);
+      Biome b = CLIMATE_BIOMES[climate][wetness];
+      if (ground[cell] < p.sea_level) {
+        b = OCEAN;
+      } else if (water[cell] > p.lake_depth) {
+        b = LAKE;
+      } else if (t < p.ice_temperature) {
+        b = ICE;
+      } else if (ground[cell] > p.mountain_height) {
+        b = MOUNTAIN;
+      }
+      biomes[cell] = b;
+    }
+  });
+}
+
+void getErosionStrength(const uint8_t* biomes, size_t n, float* strength) {
+  for (size_t i = 0; i < n; i++) {
+    strength[i] = EROSION_STRENGTH[biomes[i]];
+  }
+}
+
+const char* getName(uint8_t biome) { return (biome < NUM_BIOMES) ? NAMES[biome] : "unknown"; }
+}  // namespace biome
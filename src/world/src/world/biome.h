@@ -0,0 +1,98 @@
+#ifndef BIOME
+#define BIOME
+
+#include <cstddef>
+#include <cstdint>
+#include <utils/taskScheduler.hpp>
+
+#include "cellGrid.h"
+
+/*!
+ * \brief The area type of every cell, one byte per cell. Derived from the latitude, the
+ * ground and water height, the air temperature and a moisture which falls and rises with the
+ * latitude (wet tropics, dry subtropics, wet mid latitudes) and is shifted by noise, such
+ * that the borders of the biomes are not just circles of latitude.
+ * Later stages look up their factors (e.g. getErosionStrength(), getFertility()) by the byte
+ * instead of recomputing the climate.
+ */
+namespace biome {
+
+enum Biome : uint8_t {
+  OCEAN,
+  // land under water deeper than Parameters::lake_depth
+  LAKE,
+  ICE,
+  TUNDRA,
+  TAIGA,
+  STEPPE,
+  FOREST,
+  DESERT,
+  SAVANNA,
+  RAINFOREST,
+  // bare rock above Parameters::mountain_height
+  MOUNTAIN,
+  NUM_BIOMES
+};
+
+struct Parameters {
+  // [m] ground below is ocean
+  double sea_level = 0.;
+  // [m] of WATER height on land
+  double lake_depth = 1.;
+  // [m]
+  double mountain_height = 3000.;
+  // [K] of the AIR, land below is covered by ice
+  double ice_temperature = 258.15;
+  // [K] of the AIR, the upper borders of the cold and the temperate climate
+  double cold_temperature = 273.15;
+  double temperate_temperature = 283.15;
+  double warm_temperature = 293.15;
+  // moisture [0, 1] between dry and medium and between medium and wet
+  float dry_moisture = 0.3f;
+  float wet_moisture = 0.6f;
+  // moisture added by rivers and lakes (WATER height > 0) on land
+  float water_moisture = 0.3f;
+  // amplitude of the noise added to the moisture
+  float moisture_noise = 0.4f;
+};
+
+/*!
+ * \brief Classifies every cell in one parallel pass over blocks of cells.
+ * Deterministic: the same grid and seed give the same biomes on any number of threads.
+ * \param grid Reads GROUND HEIGHT, WATER HEIGHT and AIR TEMPERATURE, laid out as in
+ * GridGeometry.
+ * \param seed Of the moisture noise.
+ * \param scheduler Runs the blocks in parallel.
+ * \param biomes grid.getNumCells() Biome values.
+ * \param parameters The borders between the biomes.
+ */
+void classify(const CellGrid& grid,
+              uint64_t seed,
+              utils::TaskScheduler& scheduler,
+              uint8_t* biomes,
+              const Parameters& parameters = Parameters());
+
+/*!
+ * \brief The factor of erosion::erode() and erosion::ShallowWater per cell: loose sand
+ * erodes fast, roots and rock hold the ground.
+ * \param biomes n Biome values.
+ * \param strength n factors.
+ */
+void getErosionStrength(const uint8_t* biomes, size_t n, float* strength);
+
+/*!
+ * \brief How well plants grow in the biome, in [0, 1]. Inline, it is looked up per plant.
+ */
+inline float getFertility(uint8_t biome) {
+  // OCEAN, LAKE, ICE, TUNDRA, TAIGA, STEPPE, FOREST, DESERT, SAVANNA, RAINFOREST, MOUNTAIN
+  constexpr float FERTILITY[NUM_BIOMES] = {
+      0.f, 0.1f, 0.f, 0.2f, 0.6f, 0.5f, 1.f, 0.05f, 0.6f, 1.f, 0.1f};
+  return FERTILITY[biome];
+}
+
+const char* getName(uint8_t biome);
+
+constexpr size_t CELLS_PER_TASK = 4096;
+}  // namespace biome
+
+#endif
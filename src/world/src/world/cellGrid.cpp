@@ -0,0 +1,209 @@
+#include "cellGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+
+namespace {
+
+// The kernels get their arrays as restrict parameters, restrict locals do not spare GCC the
+// alias checks and it gives up vectorizing.
+// Their largest change is kept as a peak, the upper 32 bits of its magnitude. For non-negative
+// doubles these order like the values and the maximum of integers vectorizes, that of doubles
+// only with -ffinite-math-only -fno-signed-zeros.
+
+inline int32_t toPeak(double x) {
+  int64_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return static_cast<int32_t>((bits >> 32) & 0x7fffffff);
+}
+
+inline int32_t maxPeak(int32_t a, int32_t b) { return (a > b) ? a : b; }
+
+// The largest magnitude with this peak, thus at most 2^-20 too large. Infinite for NaN.
+double fromPeak(int32_t peak) {
+  if (peak == 0) {
+    return 0.;
+  }
+  if (peak >= 0x7ff00000) {
+    return std::numeric_limits<double>::infinity();
+  }
+  const int64_t bits = (static_cast<int64_t>(peak) << 32) | 0xffffffff;
+  double x;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+// Advection: d/dt = -flow * gradient. Returns the peak of the temperature changes.
+int32_t advect(size_t n,
+               double dt,
+               double* __restrict temperature,
+               double* __restrict density,
+               const double* __restrict flow_x,
+               const double* __restrict flow_y,
+               const double* __restrict flow_z,
+               const double* __restrict temp_grad_x,
+               const double* __restrict temp_grad_y,
+               const double* __restrict temp_grad_z,
+               const double* __restrict dens_grad_x,
+               const double* __restrict dens_grad_y,
+               const double* __restrict dens_grad_z) {
+  int32_t peak = 0;
+  for (size_t i = 0; i < n; i++) {
+    const double change = dt * (flow_x[i] * temp_grad_x[i] + flow_y[i] * temp_grad_y[i] +
+                                flow_z[i] * temp_grad_z[i]);
+    temperature[i] -= change;
+    peak = maxPeak(peak, toPeak(change));
+    density[i] -= dt * (flow_x[i] * dens_grad_x[i] + flow_y[i] * dens_grad_y[i] +
+                        flow_z[i] * dens_grad_z[i]);
+  }
+  return peak;
+}
+
+// The temperatures of the layers approach each other. Returns the peak of the changes.
+int32_t exchangeHeat(size_t n,
+                     double to_air,
+                     double to_water,
+                     double to_ground,
+                     double* __restrict air,
+                     double* __restrict water,
+                     double* __restrict ground) {
+  int32_t peak = 0;
+  for (size_t i = 0; i < n; i++) {
+    const double air_temperature = air[i];
+    const double air_change = to_air * (ground[i] - air_temperature);
+    const double water_change = to_water * (air_temperature - water[i]);
+    const double ground_change = to_ground * (air_temperature - ground[i]);
+    air[i] += air_change;
+    water[i] += water_change;
+    ground[i] += ground_change;
+    peak = maxPeak(peak,
+                   maxPeak(toPeak(air_change),
+                           maxPeak(toPeak(water_change), toPeak(ground_change))));
+  }
+  return peak;
+}
+}  // namespace
+
+CellGrid::CellGrid(const CellGrid& other) {
+  resize(other.num_cells);
+  if (buffer) {
+    std::memcpy(buffer.get(), other.buffer.get(), getSizeBytes());
+  }
+}
+
+CellGrid& CellGrid::operator=(const CellGrid& other) {
+  if (this != &other) {
+    if (num_cells != other.num_cells) {
+      resize(other.num_cells);
+    }
+    if (buffer) {
+      std::memcpy(buffer.get(), other.buffer.get(), getSizeBytes());
+    }
+  }
+  return *this;
+}
+
+void CellGrid::resize(size_t num_cells) {
+  buffer.reset();
+  this->num_cells = num_cells;
+  stride = getStride(num_cells);
+  if (stride == 0) {
+    return;
+  }
+  // getSizeBytes() is a multiple of CACHE_LINE_BYTES as required by aligned_alloc.
+  double* memory = static_cast<double*>(std::aligned_alloc(CACHE_LINE_BYTES, getSizeBytes()));
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  std::memset(memory, 0, getSizeBytes());
+  buffer = std::unique_ptr<double[], std::function<void(double*)>>(
+      memory, [](double* p) { std::free(p); });
+}
+
+void CellGrid::adopt(double* memory,
+                     size_t num_cells,
+                     const std::function<void(double*)>& release) {
+  buffer.reset();
+  this->num_cells = num_cells;
+  stride = getStride(num_cells);
+  buffer = std::unique_ptr<double[], std::function<void(double*)>>(memory, release);
+}
+
+LayerFields CellGrid::getLayer(LayerTyp layer) {
+  LayerFields fields;
+  fields.height = getField(layer, HEIGHT);
+  fields.temperature = getField(layer, TEMPERATURE);
+  fields.density = getField(layer, DENSITY);
+  for (int i = 0; i < 3; i++) {
+    fields.density_gradient[i] = getField(layer, static_cast<GridField>(DENSITY_GRADIENT_X + i));
+    fields.temperature_gradient[i] =
+        getField(layer, static_cast<GridField>(TEMPERATURE_GRADIENT_X + i));
+    fields.mass_flow_gradient[i] =
+        getField(layer, static_cast<GridField>(MASS_FLOW_GRADIENT_X + i));
+  }
+  return fields;
+}
+
+void CellGrid::fill(LayerTyp layer, GridField field, double value) {
+  double* values = getField(layer, field);
+  std::fill(values, values + num_cells, value);
+}
+
+void CellGrid::copyCells(const CellGrid& other, size_t begin, size_t end) {
+  end = std::min(end, num_cells);
+  if (begin >= end) {
+    return;
+  }
+  const size_t num_fields = static_cast<size_t>(NUM_LAYER_TYPES) * NUM_GRID_FIELDS;
+  const size_t bytes = (end - begin) * sizeof(double);
+  for (size_t f = 0; f < num_fields; f++) {
+    const size_t offset = f * stride + begin;
+    std::memcpy(buffer.get() + offset, other.buffer.get() + offset, bytes);
+  }
+}
+
+double CellGrid::step(double dt, size_t begin, size_t end) {
+  end = std::min(end, num_cells);
+  if (begin >= end) {
+    return 0.;
+  }
+  const size_t n = end - begin;
+  int32_t peak = 0;
+  for (int l = 0; l < NUM_LAYER_TYPES; l++) {
+    const LayerFields f = getLayer(static_cast<LayerTyp>(l));
+    peak = maxPeak(peak,
+                   advect(n,
+                          dt,
+                          f.temperature + begin,
+                          f.density + begin,
+                          f.mass_flow_gradient[0] + begin,
+                          f.mass_flow_gradient[1] + begin,
+                          f.mass_flow_gradient[2] + begin,
+                          f.temperature_gradient[0] + begin,
+                          f.temperature_gradient[1] + begin,
+                          f.temperature_gradient[2] + begin,
+                          f.density_gradient[0] + begin,
+                          f.density_gradient[1] + begin,
+                          f.density_gradient[2] + begin));
+  }
+
+  // Heat exchange between the layers of a cell. Needs no gradients, thus a world which was
+  // not presimulated changes too. The factors dt / (time + dt) stay below 1 for any dt.
+  const double to_ground = dt / (GROUND_HEAT_EXCHANGE_TIME + dt);
+  const double to_water = dt / (WATER_HEAT_EXCHANGE_TIME + dt);
+  const double to_air = dt / (AIR_HEAT_EXCHANGE_TIME + dt);
+  peak = maxPeak(peak,
+                 exchangeHeat(n,
+                              to_air,
+                              to_water,
+                              to_ground,
+                              getField(AIR, TEMPERATURE) + begin,
+                              getField(WATER, TEMPERATURE) + begin,
+                              getField(GROUND, TEMPERATURE) + begin));
+  return fromPeak(peak);
+}
@@ -0,0 +1,155 @@
+#ifndef CELL_GRID
+#define CELL_GRID
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "layer.h"
+
+// One entry per scalar stored for every cell of a layer.
+// Mirrors the members of PhyscalProperties, vectors are split into their components.
+enum GridField {
+  HEIGHT,
+  TEMPERATURE,
+  DENSITY,
+  DENSITY_GRADIENT_X,
+  DENSITY_GRADIENT_Y,
+  DENSITY_GRADIENT_Z,
+  TEMPERATURE_GRADIENT_X,
+  TEMPERATURE_GRADIENT_Y,
+  TEMPERATURE_GRADIENT_Z,
+  MASS_FLOW_GRADIENT_X,
+  MASS_FLOW_GRADIENT_Y,
+  MASS_FLOW_GRADIENT_Z,
+  NUM_GRID_FIELDS
+};
+
+/*!
+ * \brief Named pointers to the field arrays of one layer.
+ * Every pointer points to getNumCells() contiguous values.
+ */
+struct LayerFields {
+  double* height;
+  double* temperature;
+  double* density;
+  double* density_gradient[3];
+  double* temperature_gradient[3];
+  double* mass_flow_gradient[3];
+};
+
+/*!
+ * \brief Structure of arrays storage for the physical state of all cells of all layers.
+ * All fields live in one allocation. Each field array starts on a cache line and is padded
+ * to a multiple of a cache line, such that loops over one field stream through memory.
+ */
+class CellGrid {
+ public:
+  CellGrid() = default;
+
+  explicit CellGrid(size_t num_cells) { resize(num_cells); }
+
+  CellGrid(const CellGrid& other);
+  CellGrid& operator=(const CellGrid& other);
+  CellGrid(CellGrid&& other) = default;
+  CellGrid& operator=(CellGrid&& other) = default;
+
+  /*!
+   * \brief Reallocates the grid for the given number of cells. All values are set to 0.
+   * \param num_cells The number of cells per layer.
+   */
+  void resize(size_t num_cells);
+
+  /*!
+   * \brief Uses the given memory as storage instead of allocating it, e.g. a memory
+   * mapped file. The memory must have the layout described by getStride() and
+   * getSizeBytes() for the given number of cells and be aligned to a cache line.
+   * \param memory The first value of the block.
+   * \param num_cells The number of cells per layer the block holds.
+   * \param release Called with memory once the grid does not need it anymore.
+   */
+  void adopt(double* memory, size_t num_cells, const std::function<void(double*)>& release);
+
+  size_t getNumCells() const { return num_cells; }
+
+  /*!
+   * \brief Returns the distance (in values) between the start of two consecutive field arrays.
+   */
+  size_t getStride() const { return stride; }
+
+  double* getField(LayerTyp layer, GridField field) {
+    return buffer.get() + fieldOffset(layer, field);
+  }
+
+  const double* getField(LayerTyp layer, GridField field) const {
+    return buffer.get() + fieldOffset(layer, field);
+  }
+
+  LayerFields getLayer(LayerTyp layer);
+
+  /*!
+   * \brief Sets every cell of the given field to value.
+   */
+  void fill(LayerTyp layer, GridField field, double value);
+
+  /*!
+   * \brief Advances all cells by dt seconds.
+   * \param dt The time step in seconds.
+   * \return [K] See step(dt, begin, end).
+   */
+  double step(double dt) { return step(dt, 0, num_cells); }
+
+  /*!
+   * \brief Advances the cells [begin, end) by dt seconds: temperature and density move along
+   * the gradients with the mass flow, and the temperatures of the layers approach each other.
+   * Cells only read their own values, thus disjunct ranges can be stepped independently.
+   * \param dt The time step in seconds.
+   * \param begin The first cell to update.
+   * \param end One past the last cell to update.
+   * \return [K] The largest change of a temperature by one of the processes, tells how long
+   * the next step may be. Rounded up by at most a factor 1 + 2^-20, the maximum is taken over
+   * the upper bits of the changes, which vectorizes.
+   */
+  double step(double dt, size_t begin, size_t end);
+
+  /*!
+   * \brief Copies the cells [begin, end) of every field of every layer from other.
+   * Both grids must have the same number of cells.
+   */
+  void copyCells(const CellGrid& other, size_t begin, size_t end);
+
+  /*!
+   * \brief Direct access to the underlying memory block of getSizeBytes() bytes.
+   */
+  const double* data() const { return buffer.get(); }
+  double* data() { return buffer.get(); }
+
+  size_t getSizeBytes() const { return getSizeBytes(num_cells); }
+
+  static size_t getStride(size_t num_cells) {
+    return (num_cells + VALUES_PER_CACHE_LINE - 1) / VALUES_PER_CACHE_LINE * VALUES_PER_CACHE_LINE;
+  }
+
+  static size_t getSizeBytes(size_t num_cells) {
+    return getStride(num_cells) * NUM_LAYER_TYPES * NUM_GRID_FIELDS * sizeof(double);
+  }
+
+  // [s] how fast the temperature of a layer approaches the one of the AIR (AIR: of the GROUND)
+  static constexpr double AIR_HEAT_EXCHANGE_TIME = 5. * 86400.;
+  static constexpr double WATER_HEAT_EXCHANGE_TIME = 30. * 86400.;
+  static constexpr double GROUND_HEAT_EXCHANGE_TIME = 10. * 86400.;
+
+  static constexpr size_t CACHE_LINE_BYTES = 64;
+  static constexpr size_t VALUES_PER_CACHE_LINE = CACHE_LINE_BYTES / sizeof(double);
+
+ private:
+  size_t fieldOffset(LayerTyp layer, GridField field) const {
+    return (static_cast<size_t>(layer) * NUM_GRID_FIELDS + static_cast<size_t>(field)) * stride;
+  }
+
+  std::unique_ptr<double[], std::function<void(double*)>> buffer;
+  size_t num_cells = 0;
+  size_t stride = 0;
+};
+
+#endif
@@ -0,0 +1,177 @@
+#include "checkpointer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <globals/macros.hpp>
+
+Checkpointer::Checkpointer() { writer = std::thread(&Checkpointer::run, this); }
+
+Checkpointer::~Checkpointer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  job_changed.notify_all();
+  writer.join();
+}
+
+bool Checkpointer::isBusy() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return busy;
+}
+
+CellGrid& Checkpointer::beginFreeze(size_t num_cells) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    busy = true;
+  }
+  if (frozen_grid.getNumCells() != num_cells) {
+    frozen_grid.resize(num_cells);
+  }
+  return frozen_grid;
+}
+
+void Checkpointer::commitFreeze(const std::string& file, const world_file::WorldInfo& info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    frozen_file = file;
+    frozen_info = info;
+    has_job = true;
+  }
+  job_changed.notify_all();
+}
+
+void Checkpointer::waitUntilIdle() {
+  std::unique_lock<std::mutex> lock(mutex);
+  job_changed.wait(lock, [this] { return !busy; });
+}
+
+void Checkpointer::resetReference() {
+  std::unique_lock<std::mutex> lock(mutex);
+  job_changed.wait(lock, [this] { return !busy; });
+  // An empty chain makes write() save a keyframe, the grid keeps its memory.
+  reference_chain.clear();
+  reference_tick = 0;
+}
+
+void Checkpointer::recordTick(double duration, bool froze) {
+  std::lock_guard<std::mutex> lock(mutex);
+  // running mean: m_n = m_(n-1) + (x - m_(n-1)) / n
+  if (froze || busy) {
+    stats.num_ticks_checkpointing++;
+    stats.mean_tick_duration_checkpointing +=
+        (duration - stats.mean_tick_duration_checkpointing) / stats.num_ticks_checkpointing;
+    stats.max_tick_duration_checkpointing =
+        std::max(stats.max_tick_duration_checkpointing, duration);
+  } else {
+    stats.num_ticks_idle++;
+    stats.mean_tick_duration_idle +=
+        (duration - stats.mean_tick_duration_idle) / stats.num_ticks_idle;
+  }
+}
+
+CheckpointStats Checkpointer::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+std::vector<CheckpointResult> Checkpointer::takeResults() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<CheckpointResult> taken;
+  taken.swap(results);
+  return taken;
+}
+
+void Checkpointer::setKeyframeInterval(unsigned int interval) {
+  std::lock_guard<std::mutex> lock(mutex);
+  keyframe_interval =
+      std::clamp(interval, 1u, static_cast<unsigned int>(world_file::MAX_DELTA_CHAIN));
+}
+
+bool Checkpointer::write(const std::string& file, const world_file::WorldInfo& info) {
+  unsigned int interval;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    interval = keyframe_interval;
+  }
+  // A delta must not replace a file it depends on.
+  const bool is_in_chain =
+      std::find(reference_chain.begin(), reference_chain.end(), file) != reference_chain.end();
+  const bool write_delta = !reference_chain.empty() && reference_chain.size() < interval &&
+                           !is_in_chain &&
+                           reference_grid.getNumCells() == frozen_grid.getNumCells();
+
+  bool success;
+  if (write_delta) {
+    const std::vector<uint64_t> changed_blocks =
+        world_file::getChangedBlocks(frozen_grid, reference_grid);
+    success = world_file::saveDelta(
+        file, frozen_grid, changed_blocks, reference_chain.back(), reference_tick, info);
+  } else {
+    success = world_file::save(file, frozen_grid, info);
+  }
+
+  if (!success) {
+    // The file might be gone, the next checkpoint must not depend on it.
+    reference_chain.clear();
+    return false;
+  }
+  if (!write_delta) {
+    reference_chain.clear();
+  }
+  reference_chain.push_back(file);
+  reference_tick = info.tick;
+  // The frozen grid becomes the reference, the old reference is overwritten by the next
+  // freeze. Both keep their memory.
+  std::swap(reference_grid, frozen_grid);
+
+  std::error_code error;
+  const uint64_t size = std::filesystem::file_size(file, error);
+  std::lock_guard<std::mutex> lock(mutex);
+  stats.num_deltas += write_delta ? 1 : 0;
+  stats.bytes_written += error ? 0 : size;
+  stats.bytes_full += world_file::CHUNK_ALIGNMENT + reference_grid.getSizeBytes();
+  return true;
+}
+
+void Checkpointer::run() {
+  while (true) {
+    std::string file;
+    world_file::WorldInfo info;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      job_changed.wait(lock, [this] { return stop || has_job; });
+      if (!has_job) {
+        return;
+      }
+      file = frozen_file;
+      info = frozen_info;
+    }
+
+    // frozen_grid is not touched by the simulation thread until busy is false again.
+    const auto start = std::chrono::steady_clock::now();
+    const bool success = write(file, info);
+    const std::chrono::duration<double> write_duration = std::chrono::steady_clock::now() - start;
+    if (!success) {
+      F_ERROR("Failed to write checkpoint %s.", file.c_str());
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      has_job = false;
+      busy = false;
+      stats.last_write_duration = write_duration.count();
+      if (success) {
+        stats.num_written++;
+      } else {
+        stats.num_failed++;
+      }
+      if (results.size() == MAX_RESULTS) {
+        results.erase(results.begin());
+      }
+      results.push_back({file, success});
+    }
+    job_changed.notify_all();
+  }
+}
@@ -0,0 +1,165 @@
+#ifndef CHECKPOINTER
+#define CHECKPOINTER
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cellGrid.h"
+#include "worldFile.h"
+
+/*!
+ * \brief Measurements to judge how much writing checkpoints slows down the simulation.
+ * All durations in seconds.
+ */
+struct CheckpointStats {
+  uint64_t num_written = 0;
+  uint64_t num_failed = 0;
+  // number of written checkpoints which only hold the changes since the previous one
+  uint64_t num_deltas = 0;
+  // duration of the last background write
+  double last_write_duration = 0.;
+  // [byte] size of all written checkpoints and what full files would have needed
+  uint64_t bytes_written = 0;
+  uint64_t bytes_full = 0;
+
+  // latency of ticks while no checkpoint was frozen or written
+  uint64_t num_ticks_idle = 0;
+  double mean_tick_duration_idle = 0.;
+  // latency of ticks which froze a checkpoint or ran while one was written
+  uint64_t num_ticks_checkpointing = 0;
+  double mean_tick_duration_checkpointing = 0.;
+  double max_tick_duration_checkpointing = 0.;
+
+  /*!
+   * \brief Relative slow down of a tick while checkpointing, e.g. 0.1 means 10% slower.
+   */
+  double getTickLatencyImpact() const {
+    if (num_ticks_idle == 0 || num_ticks_checkpointing == 0 || mean_tick_duration_idle <= 0.) {
+      return 0.;
+    }
+    return mean_tick_duration_checkpointing / mean_tick_duration_idle - 1.;
+  }
+};
+
+/*!
+ * \brief The outcome of a background write, for the user to see.
+ */
+struct CheckpointResult {
+  std::string file;
+  bool success = false;
+};
+
+/*!
+ * \brief Writes frozen copies of the world on a background thread.
+ * The simulation thread fills the grid returned by beginFreeze() (e.g. tile by tile while
+ * the tiles are still in cache) and hands it over with commitFreeze(). The simulation
+ * continues while the copy is written.
+ * With a keyframe interval > 1 only every n-th checkpoint is a full file (keyframe), the
+ * others are deltas holding the blocks which changed since the previous checkpoint.
+ */
+class Checkpointer {
+ public:
+  Checkpointer();
+
+  /*!
+   * \brief Finishes a running write before returning.
+   */
+  ~Checkpointer();
+
+  Checkpointer(const Checkpointer&) = delete;
+  Checkpointer& operator=(const Checkpointer&) = delete;
+
+  /*!
+   * \brief True while a checkpoint is frozen or written. No new one can be started then.
+   */
+  bool isBusy() const;
+
+  /*!
+   * \brief Simulation thread: Returns the grid to copy the state into. Only valid if
+   * !isBusy(). Reuses its memory if the number of cells did not change.
+   * \param num_cells The number of cells of the grid to be frozen.
+   */
+  CellGrid& beginFreeze(size_t num_cells);
+
+  /*!
+   * \brief Simulation thread: The frozen grid is complete, write it in the background.
+   * \param file The path to the file.
+   * \param info The non grid state belonging to the frozen grid.
+   */
+  void commitFreeze(const std::string& file, const world_file::WorldInfo& info);
+
+  /*!
+   * \brief Blocks until the running write (if any) is finished.
+   */
+  void waitUntilIdle();
+
+  /*!
+   * \brief Simulation thread: The next checkpoint is a keyframe, it depends on no file
+   * written before. Call when the world was replaced or files of the chain may have been
+   * overwritten. Waits for the running write, not between beginFreeze() and commitFreeze().
+   */
+  void resetReference();
+
+  /*!
+   * \brief Simulation thread: Adds the duration of one tick to the statistics.
+   * \param duration [s] The wall time the tick took.
+   * \param froze True if the tick copied a checkpoint.
+   */
+  void recordTick(double duration, bool froze);
+
+  CheckpointStats getStats() const;
+
+  /*!
+   * \brief Thread safe. Returns the results of the writes finished since the last call,
+   * the oldest first. Keeps at most MAX_RESULTS.
+   */
+  std::vector<CheckpointResult> takeResults();
+
+  /*!
+   * \brief Thread safe. Sets how often a full file is written.
+   * \param interval 1: every checkpoint is a full file, n: every n-th checkpoint is a
+   * full file, the n - 1 in between are deltas. Restoring a delta loads at most n files.
+   * Clamped to [1, world_file::MAX_DELTA_CHAIN], longer chains could not be loaded.
+   */
+  void setKeyframeInterval(unsigned int interval);
+
+ private:
+  void run();
+
+  /*!
+   * \brief Writer thread: Writes frozen_grid as keyframe or delta.
+   * \return True on success.
+   */
+  bool write(const std::string& file, const world_file::WorldInfo& info);
+
+  mutable std::mutex mutex;
+  std::condition_variable job_changed;
+  std::thread writer;
+  bool stop = false;
+  // true from beginFreeze() until the write finished
+  bool busy = false;
+  bool has_job = false;
+
+  CellGrid frozen_grid;
+  world_file::WorldInfo frozen_info;
+  std::string frozen_file;
+
+  CheckpointStats stats;
+  std::vector<CheckpointResult> results;
+
+  // Writer thread only (and resetReference() while idle): the previous checkpoint, which the
+  // next delta is based on, and the files restoring it needs, starting with its keyframe.
+  CellGrid reference_grid;
+  std::vector<std::string> reference_chain;
+  uint64_t reference_tick = 0;
+  unsigned int keyframe_interval = 1;
+
+  // Without anyone taking the results (e.g. evosym_headless) only the latest are kept.
+  static constexpr size_t MAX_RESULTS = 64;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "convergenceMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Sum of (current - previous)^2, previous becomes current.
+double swapInSquaredChanges(size_t n,
+                            const double* __restrict current,
+                            double* __restrict previous) {
+  double sum = 0.;
+  for (size_t i = 0; i < n; i++) {
+    const double change = current[i] - previous[i];
+    sum += change * change;
+    previous[i] = current[i];
+  }
+  return sum;
+}
+}  // namespace
+
+void ConvergenceMonitor::reset() {
+  residuals = Residuals();
+  num_checks = 0;
+  num_settled = 0;
+  for (int f = 0; f < NUM_FIELDS; f++) {
+    previous[f].clear();
+  }
+}
+
+const Residuals& ConvergenceMonitor::check(const CellGrid& grid,
+                                           utils::TaskScheduler& scheduler) {
+  const size_t num_cells = grid.getNumCells();
+  const double* current[NUM_FIELDS] = {grid.getField(GROUND, HEIGHT),
+                                       grid.getField(WATER, HEIGHT),
+                                       grid.getField(AIR, TEMPERATURE)};
+  if (num_checks == 0 || previous[0].size() != num_cells) {
+    reset();
+    for (int f = 0; f < NUM_FIELDS; f++) {
+      previous[f].assign(current[f], current[f] + num_cells);
+    }
+    num_checks = 1;
+    return residuals;
+  }
+
+  const size_t num_tasks = (num_cells + CELLS_PER_TASK - 1) / CELLS_PER_TASK;
+  partials.resize(num_tasks);
+  scheduler.parallelFor(num_tasks, [&](size_t task) {
+    const size_t begin = task * CELLS_PER_TASK;
+    const size_t n = std::min(num_cells, begin + CELLS_PER_TASK) - begin;
+    for (int f = 0; f < NUM_FIELDS; f++) {
+      partials[task].squares[f] =
+          swapInSquaredChanges(n, current[f] + begin, previous[f].data() + begin);
+    }
+  });
+
+  double squares[NUM_FIELDS] = {};
+  for (const Partial& partial : partials) {
+    for (int f = 0; f < NUM_FIELDS; f++) {
+      squares[f] += partial.squares[f];
+    }
+  }
+  const double cells = static_cast<double>(std::max<size_t>(num_cells, 1));
+  residuals.height = std::sqrt((squares[GROUND_HEIGHT] + squares[WATER_HEIGHT]) / (2. * cells));
+  residuals.temperature = std::sqrt(squares[AIR_TEMPERATURE] / cells);
+
+  num_checks++;
+  const bool settled = residuals.height < settings.height_tolerance &&
+                       residuals.temperature < settings.temperature_tolerance;
+  num_settled = settled ? num_settled + 1 : 0;
+  return residuals;
+}
@@ -0,0 +1,90 @@
+#ifndef CONVERGENCE_MONITOR
+#define CONVERGENCE_MONITOR
+
+#include <cstddef>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+#include "cellGrid.h"
+
+/*!
+ * \brief How much the world changed between two checks of a ConvergenceMonitor.
+ */
+struct Residuals {
+  // [m] root mean square change of the GROUND and the WATER heights
+  double height = 0.;
+  // [K] root mean square change of the AIR temperature
+  double temperature = 0.;
+};
+
+struct ConvergenceSettings {
+  // [m] and [K] a check with residuals below both counts as settled
+  double height_tolerance = 1e-3;
+  double temperature_tolerance = 1e-2;
+  // the world is settled after this many settled checks in a row
+  size_t settled_checks = 4;
+};
+
+/*!
+ * \brief Tells when the world stopped changing, e.g. to end a presimulation
+ * (World::presimulate()). Every check compares the grid with a copy of the monitored fields
+ * from the previous check. The cells are split into blocks which are compared in parallel,
+ * each task sums into its own partial which are added up in order after parallelFor(), thus
+ * the residuals do not depend on the number of threads.
+ */
+class ConvergenceMonitor {
+ public:
+  ConvergenceMonitor() = default;
+
+  explicit ConvergenceMonitor(const ConvergenceSettings& settings) : settings(settings) {}
+
+  /*!
+   * \brief Forgets the previous checks, the next check only copies the grid.
+   */
+  void reset();
+
+  /*!
+   * \brief Compares the grid with the one of the previous check and keeps a copy of it for the
+   * next check.
+   * \param grid Needs the number of cells of the previous check, else the check starts over
+   * as after reset().
+   * \param scheduler Runs blocks of cells in parallel.
+   * \return The residuals, all 0 for the first check.
+   */
+  const Residuals& check(const CellGrid& grid, utils::TaskScheduler& scheduler);
+
+  /*!
+   * \brief True if the last ConvergenceSettings::settled_checks checks had residuals below
+   * the tolerances.
+   */
+  bool isSettled() const { return num_settled >= settings.settled_checks; }
+
+  // of the last check
+  const Residuals& getResiduals() const { return residuals; }
+
+  // since reset()
+  size_t getNumChecks() const { return num_checks; }
+
+  const ConvergenceSettings& getSettings() const { return settings; }
+
+ private:
+  enum Field { GROUND_HEIGHT, WATER_HEIGHT, AIR_TEMPERATURE, NUM_FIELDS };
+
+  // Sums of the squared changes of one block. One cache line each, the tasks writing their
+  // partials do not slow each other down.
+  struct alignas(64) Partial {
+    double squares[NUM_FIELDS];
+  };
+
+  ConvergenceSettings settings;
+  Residuals residuals;
+  size_t num_checks = 0;
+  size_t num_settled = 0;
+  // the monitored fields at the previous check
+  std::vector<double> previous[NUM_FIELDS];
+  std::vector<Partial> partials;
+
+  static constexpr size_t CELLS_PER_TASK = 8192;
+};
+
+#endif
@@ -0,0 +1,365 @@
+#include "creature.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utils/hash.hpp>
+
+namespace {
+// each component in [-1, 1)
+Eigen::Vector3f randomVector(uint64_t seed) {
+  Eigen::Vector3f v;
+  for (int i = 0; i < 3; i++) {
+    v[i] = 2.f * utils::toUnitFloat(utils::hash(seed + i)) - 1.f;
+  }
+  return v;
+}
+
+// A tangential velocity of the given speed in a random direction.
+Eigen::Vector3f randomVelocity(const Eigen::Vector3f& position, float speed, uint64_t seed) {
+  const Eigen::Vector3f direction = randomVector(seed);
+  const Eigen::Vector3f tangent = direction - direction.dot(position) * position;
+  const float norm = tangent.norm();
+  return (norm > 1e-6f) ? Eigen::Vector3f(speed / norm * tangent) : Eigen::Vector3f::Zero();
+}
+
+bool hasField(CreatureArchetype archetype, CreatureField field) {
+  switch (field) {
+    case VELOCITY_X:
+    case VELOCITY_Y:
+    case VELOCITY_Z:
+      return archetype == MOBILE;
+    default:
+      return true;
+  }
+}
+
+// The move and metabolism kernels have no branches and work on restrict pointers, the
+// compiler vectorizes them.
+
+// Moves along the velocity and projects back onto the unit sphere, the velocity stays
+// tangential.
+void moveKernel(size_t n,
+                float dt,
+                float* __restrict x,
+                float* __restrict y,
+                float* __restrict z,
+                float* __restrict vx,
+                float* __restrict vy,
+                float* __restrict vz) {
+  for (size_t i = 0; i < n; i++) {
+    const float px = x[i] + dt * vx[i];
+    const float py = y[i] + dt * vy[i];
+    const float pz = z[i] + dt * vz[i];
+    const float inv_norm = 1.f / std::sqrt(px * px + py * py + pz * pz);
+    x[i] = px * inv_norm;
+    y[i] = py * inv_norm;
+    z[i] = pz * inv_norm;
+    const float radial = vx[i] * x[i] + vy[i] * y[i] + vz[i] * z[i];
+    vx[i] -= radial * x[i];
+    vy[i] -= radial * y[i];
+    vz[i] -= radial * z[i];
+  }
+}
+
+void metabolismKernel(size_t n,
+                      float dt,
+                      float* __restrict energy,
+                      const float* __restrict vx,
+                      const float* __restrict vy,
+                      const float* __restrict vz) {
+  constexpr float BASE = CreaturePopulation::BASE_METABOLISM;
+  constexpr float MOVEMENT = CreaturePopulation::MOVEMENT_METABOLISM;
+  for (size_t i = 0; i < n; i++) {
+    const float speed_squared = vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i];
+    energy[i] -= dt * (BASE + MOVEMENT * speed_squared);
+  }
+}
+
+void metabolismKernel(size_t n, float dt, float* __restrict energy) {
+  for (size_t i = 0; i < n; i++) {
+    energy[i] -= dt * CreaturePopulation::BASE_METABOLISM;
+  }
+}
+
+void cellKernel(size_t n,
+                uint32_t num_cells,
+                const float* __restrict x,
+                const float* __restrict y,
+                const float* __restrict z,
+                uint32_t* __restrict cells) {
+  for (size_t i = 0; i < n; i++) {
+    cells[i] = GridGeometry::getCell(x[i], y[i], z[i], num_cells);
+  }
+}
+}  // namespace
+
+CreatureChunk::CreatureChunk(tool::PreciseTime t0, CreatureArchetype archetype)
+    : SimulatedUnit(t0), archetype(archetype) {
+  for (int f = 0; f < NUM_CREATURE_FIELDS; f++) {
+    if (hasField(archetype, static_cast<CreatureField>(f))) {
+      fields[f].resize(CAPACITY);
+    }
+  }
+  genomes.resize(CAPACITY);
+  entities.resize(CAPACITY);
+  cells.resize(CAPACITY);
+}
+
+size_t CreatureChunk::add(const Creature& creature, const utils::Handle& entity) {
+  const size_t row = num_creatures++;
+  for (int i = 0; i < 3; i++) {
+    fields[POSITION_X + i][row] = creature.position[i];
+    if (!fields[VELOCITY_X + i].empty()) {
+      fields[VELOCITY_X + i][row] = creature.velocity[i];
+    }
+  }
+  fields[ENERGY][row] = creature.energy;
+  genomes[row] = creature.genome;
+  entities[row] = entity;
+  cells[row] = GridGeometry::getCell(
+      creature.position.x(), creature.position.y(), creature.position.z(), num_cells);
+  return row;
+}
+
+utils::Handle CreatureChunk::remove(size_t row) {
+  const size_t last = --num_creatures;
+  if (row == last) {
+    return utils::Handle();
+  }
+  for (auto& field : fields) {
+    if (!field.empty()) {
+      field[row] = field[last];
+    }
+  }
+  genomes[row] = genomes[last];
+  entities[row] = entities[last];
+  cells[row] = cells[last];
+  return entities[row];
+}
+
+Creature CreatureChunk::get(size_t row) const {
+  Creature creature;
+  creature.archetype = archetype;
+  for (int i = 0; i < 3; i++) {
+    creature.position[i] = fields[POSITION_X + i][row];
+    if (!fields[VELOCITY_X + i].empty()) {
+      creature.velocity[i] = fields[VELOCITY_X + i][row];
+    }
+  }
+  creature.energy = fields[ENERGY][row];
+  creature.genome = genomes[row];
+  return creature;
+}
+
+void CreatureChunk::update(tool::PreciseTime tnow) {
+  const float dt = std::chrono::duration<float>(tnow - t_last_update).count();
+  float* energy = fields[ENERGY].data();
+  switch (archetype) {
+    case MOBILE:
+      moveKernel(num_creatures,
+                 dt,
+                 fields[POSITION_X].data(),
+                 fields[POSITION_Y].data(),
+                 fields[POSITION_Z].data(),
+                 fields[VELOCITY_X].data(),
+                 fields[VELOCITY_Y].data(),
+                 fields[VELOCITY_Z].data());
+      metabolismKernel(num_creatures,
+                       dt,
+                       energy,
+                       fields[VELOCITY_X].data(),
+                       fields[VELOCITY_Y].data(),
+                       fields[VELOCITY_Z].data());
+      cellKernel(num_creatures,
+                 num_cells,
+                 fields[POSITION_X].data(),
+                 fields[POSITION_Y].data(),
+                 fields[POSITION_Z].data(),
+                 cells.data());
+      break;
+    default:
+      // Sessile creatures do not change their cell.
+      metabolismKernel(num_creatures, dt, energy);
+      break;
+  }
+}
+
+void CreaturePopulation::resize(size_t num_cells, tool::PreciseTime t) {
+  this->num_cells = static_cast<uint32_t>(std::max<size_t>(num_cells, 1));
+  t_last_update = t;
+  pool.clear();
+  locations.clear();
+  genomes.clear();
+  for (auto& chunk : chunks) {
+    chunk->clear();
+    chunk->setNumCells(this->num_cells);
+  }
+  for (int a = 0; a < NUM_CREATURE_ARCHETYPES; a++) {
+    chunks_with_space[a].clear();
+  }
+  for (uint32_t c = 0; c < chunks.size(); c++) {
+    chunks_with_space[chunks[c]->getArchetype()].push_back(c);
+  }
+}
+
+utils::Handle CreaturePopulation::add(const Creature& creature, tool::PreciseTime t) {
+  std::vector<uint32_t>& with_space = chunks_with_space[creature.archetype];
+  if (with_space.empty()) {
+    with_space.push_back(static_cast<uint32_t>(chunks.size()));
+    chunks.emplace_back(std::make_unique<CreatureChunk>(t, creature.archetype));
+    chunks.back()->setNumCells(num_cells);
+  }
+  const uint32_t c = with_space.back();
+  CreatureChunk& chunk = *chunks[c];
+  if (chunk.size() == 0) {
+    // A reused chunk must not simulate the time it was empty.
+    chunk.restart(t);
+  }
+
+  const utils::Handle entity = pool.create();
+  if (entity.index >= locations.size()) {
+    locations.resize(pool.getNumSlots());
+  }
+  locations[entity.index] = {c, static_cast<uint32_t>(chunk.add(creature, entity))};
+  if (chunk.isFull()) {
+    with_space.pop_back();
+  }
+  return entity;
+}
+
+void CreaturePopulation::spawn(size_t num_creatures, uint64_t seed, tool::PreciseTime t) {
+  for (size_t i = 0; i < num_creatures; i++) {
+    const uint64_t r = utils::hash(seed ^ utils::hash(i));
+    Creature creature;
+    creature.archetype = (i % 2 == 0) ? SESSILE : MOBILE;
+    creature.position = randomVector(r);
+    if (creature.position.squaredNorm() < 1e-6f) {
+      creature.position = Eigen::Vector3f::UnitZ();
+    }
+    creature.position.normalize();
+    creature.genome = genomes.addRandom(r + 6);
+    if (creature.archetype == MOBILE) {
+      const float speed = MAX_SPEED * genomes.getGene(creature.genome, GENE_SPEED);
+      creature.velocity = randomVelocity(creature.position, speed, r + 3);
+    }
+    creature.energy = INITIAL_ENERGY;
+    add(creature, t);
+  }
+}
+
+bool CreaturePopulation::remove(const utils::Handle& creature) {
+  if (!pool.destroy(creature)) {
+    return false;
+  }
+  const Location location = locations[creature.index];
+  CreatureChunk& chunk = *chunks[location.chunk];
+  if (chunk.isFull()) {
+    chunks_with_space[chunk.getArchetype()].push_back(location.chunk);
+  }
+  genomes.remove(chunk.getGenome(location.row));
+  const utils::Handle moved = chunk.remove(location.row);
+  if (pool.isAlive(moved)) {
+    locations[moved.index].row = location.row;
+  }
+  return true;
+}
+
+Creature CreaturePopulation::get(const utils::Handle& creature) const {
+  const Location location = locations[creature.index];
+  return chunks[location.chunk]->get(location.row);
+}
+
+void CreaturePopulation::update(tool::PreciseTime tnow,
+                                utils::TaskScheduler& scheduler,
+                                PlantPopulation& plants) {
+  const double dt = std::chrono::duration<double>(tnow - t_last_update).count();
+  t_last_update = tnow;
+
+  // Chunks are independent of each other.
+  scheduler.parallelFor(chunks.size(), [this, tnow](size_t c) { chunks[c]->simulate(tnow); });
+
+  // Grazing is not thread safe, the cells were computed in parallel above.
+  for (uint32_t c = 0; c < chunks.size(); c++) {
+    feed(*chunks[c], dt, plants);
+    removeStarved(c);
+  }
+  reproduce(scheduler, tnow);
+  num_updates++;
+}
+
+void CreaturePopulation::feed(CreatureChunk& chunk, double dt, PlantPopulation& plants) {
+  const float demand = static_cast<float>(dt) * FEEDING_RATE;
+  const uint32_t* cells = chunk.getCells();
+  float* energy = chunk.getField(ENERGY);
+  for (size_t row = 0; row < chunk.size(); row++) {
+    energy[row] += ENERGY_PER_BIOMASS * plants.graze(cells[row], demand);
+  }
+}
+
+void CreaturePopulation::removeStarved(uint32_t c) {
+  CreatureChunk& chunk = *chunks[c];
+  const float* energy = chunk.getField(ENERGY);
+  // Backwards: remove() only moves creatures from behind row, which were checked already.
+  for (size_t row = chunk.size(); row-- > 0;) {
+    if (energy[row] <= 0.f) {
+      remove(chunk.getEntity(row));
+    }
+  }
+}
+
+void CreaturePopulation::reproduce(utils::TaskScheduler& scheduler, tool::PreciseTime t) {
+  // Collect all parents of this tick first: the children are added to the chunks which are
+  // iterated here.
+  parents.clear();
+  for (auto& chunk : chunks) {
+    float* energy = chunk->getField(ENERGY);
+    for (size_t row = 0; row < chunk->size(); row++) {
+      const float fertility = genomes.getGene(chunk->getGenome(row), GENE_FERTILITY);
+      if (energy[row] > REPRODUCTION_ENERGY * (1.5f - fertility)) {
+        energy[row] *= 0.5f;
+        parents.push_back(chunk->get(row));
+      }
+    }
+  }
+  if (parents.empty()) {
+    return;
+  }
+
+  // Every parent mates with the closest other parent in reach, without one it clones itself.
+  parent_index.build(parents.size(), [this](uint32_t i) { return parents[i].position; });
+  births.resize(parents.size());
+  const size_t num_tasks = (parents.size() + PARENTS_PER_TASK - 1) / PARENTS_PER_TASK;
+  scheduler.parallelFor(num_tasks, [this](size_t task) {
+    std::vector<SpatialIndex::Neighbor> closest;
+    const size_t end = std::min(parents.size(), (task + 1) * PARENTS_PER_TASK);
+    for (size_t i = task * PARENTS_PER_TASK; i < end; i++) {
+      parent_index.findNearest(parents[i].position, 2, closest);
+      size_t mate = i;
+      float mate_distance_squared = SpatialIndex::toDistanceSquared(MATING_DISTANCE);
+      for (const auto& neighbor : closest) {
+        if (neighbor.id != i && neighbor.distance_squared <= mate_distance_squared &&
+            (mate == i || neighbor.distance_squared < mate_distance_squared)) {
+          mate = neighbor.id;
+          mate_distance_squared = neighbor.distance_squared;
+        }
+      }
+      births[i] = {parents[i].genome, parents[mate].genome};
+    }
+  });
+  const uint64_t seed = utils::hash(num_updates);
+  genomes.reproduce(births, children, scheduler, seed);
+
+  for (size_t i = 0; i < parents.size(); i++) {
+    const uint64_t r = utils::hash(seed ^ utils::hash(i));
+    Creature child = parents[i];
+    child.position += BIRTH_DISTANCE * randomVector(r);
+    child.position.normalize();
+    child.genome = children[i];
+    if (child.archetype == MOBILE) {
+      const float speed = MAX_SPEED * genomes.getGene(child.genome, GENE_SPEED);
+      child.velocity = randomVelocity(child.position, speed, r + 3);
+    }
+    add(child, t);
+  }
+}
@@ -0,0 +1,234 @@
+#ifndef CREATURE
+#define CREATURE
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <memory>
+#include <utils/handlePool.hpp>
+#include <utils/simulatedUnit.hpp>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+#include "genome.h"
+#include "gridGeometry.h"
+#include "plant.h"
+#include "spatialIndex.h"
+
+// The set of components a creature has. All creatures of one archetype are stored
+// together and updated by the same kernels.
+enum CreatureArchetype { SESSILE, MOBILE, NUM_CREATURE_ARCHETYPES };
+
+// One entry per float component. Positions are on the unit sphere, velocities are
+// tangential to it.
+enum CreatureField {
+  POSITION_X,
+  POSITION_Y,
+  POSITION_Z,
+  VELOCITY_X,
+  VELOCITY_Y,
+  VELOCITY_Z,
+  ENERGY,
+  NUM_CREATURE_FIELDS
+};
+
+/*!
+ * \brief The state of one creature, used to add creatures and to read them one by one.
+ */
+struct Creature {
+  CreatureArchetype archetype = SESSILE;
+  Eigen::Vector3f position = Eigen::Vector3f::UnitZ();
+  // [1/s] ignored for SESSILE
+  Eigen::Vector3f velocity = Eigen::Vector3f::Zero();
+  // [J]
+  float energy = 0.f;
+  utils::Handle genome;
+};
+
+/*!
+ * \brief Up to CAPACITY creatures of one archetype as structure of arrays. Only the arrays
+ * of the components of the archetype exist. The rows [0, size()) are occupied, removing
+ * a creature moves the last one into its row.
+ * One chunk is one SimulatedUnit: the update kernels loop over the arrays without a call
+ * per creature.
+ */
+class CreatureChunk : public SimulatedUnit {
+ public:
+  static constexpr size_t CAPACITY = 4096;
+
+  CreatureChunk(tool::PreciseTime t0, CreatureArchetype archetype);
+
+  CreatureArchetype getArchetype() const { return archetype; }
+
+  size_t size() const { return num_creatures; }
+
+  bool isFull() const { return num_creatures == CAPACITY; }
+
+  /*!
+   * \brief Appends a creature. The chunk must not be full.
+   * \param entity The handle the creature is known by outside of the chunk.
+   * \return The row of the creature.
+   */
+  size_t add(const Creature& creature, const utils::Handle& entity);
+
+  /*!
+   * \brief Removes a creature by moving the last creature into its row.
+   * \return The entity which was moved into row, an invalid handle if row was the last one.
+   */
+  utils::Handle remove(size_t row);
+
+  Creature get(size_t row) const;
+
+  /*!
+   * \brief The array of the field for all rows, nullptr if the archetype lacks it.
+   */
+  float* getField(CreatureField field) {
+    return fields[field].empty() ? nullptr : fields[field].data();
+  }
+  const float* getField(CreatureField field) const {
+    return fields[field].empty() ? nullptr : fields[field].data();
+  }
+
+  const utils::Handle& getEntity(size_t row) const { return entities[row]; }
+
+  const utils::Handle& getGenome(size_t row) const { return genomes[row]; }
+
+  /*!
+   * \brief The cell each creature was in during the last update, see GridGeometry.
+   */
+  const uint32_t* getCells() const { return cells.data(); }
+
+  void setNumCells(uint32_t num_cells) { this->num_cells = num_cells; }
+
+  /*!
+   * \brief Removes all creatures, the memory is kept.
+   */
+  void clear() { num_creatures = 0; }
+
+  /*!
+   * \brief The next update only simulates the time since t.
+   */
+  void restart(tool::PreciseTime t) { t_last_update = t; }
+
+ protected:
+  void update(tool::PreciseTime tnow) override;
+
+ private:
+  CreatureArchetype archetype;
+  size_t num_creatures = 0;
+  uint32_t num_cells = 1;
+
+  std::vector<float> fields[NUM_CREATURE_FIELDS];
+  std::vector<utils::Handle> genomes;
+  std::vector<utils::Handle> entities;
+  std::vector<uint32_t> cells;
+};
+
+/*!
+ * \brief All creatures of the world, an entity component system: a creature is a handle,
+ * its components live in the chunks of its archetype.
+ * Per tick the chunks move and metabolize in parallel (see CreatureChunk), then the
+ * creatures feed on the plants of their cell and the starved ones are removed. Last all
+ * creatures with enough energy reproduce in one batch, each with the closest other parent
+ * found by a SpatialIndex, see GenomeArena::reproduce().
+ */
+class CreaturePopulation {
+ public:
+  /*!
+   * \brief Removes all creatures.
+   * \param num_cells The number of cells of the CellGrid, see GridGeometry.
+   * \param t The current simulation time.
+   */
+  void resize(size_t num_cells, tool::PreciseTime t);
+
+  /*!
+   * \param creature Its genome must be alive, it is owned by the creature from now on.
+   * \param t The current simulation time.
+   * \return The handle to refer to the creature.
+   */
+  utils::Handle add(const Creature& creature, tool::PreciseTime t);
+
+  /*!
+   * \brief Adds num_creatures creatures with random genomes at random positions, half of
+   * them MOBILE.
+   * \param seed Different seeds give different creatures.
+   */
+  void spawn(size_t num_creatures, uint64_t seed, tool::PreciseTime t);
+
+  /*!
+   * \return False if the creature was already dead.
+   */
+  bool remove(const utils::Handle& creature);
+
+  bool isAlive(const utils::Handle& creature) const { return pool.isAlive(creature); }
+
+  Creature get(const utils::Handle& creature) const;
+
+  size_t size() const { return pool.size(); }
+
+  const GenomeArena& getGenomes() const { return genomes; }
+
+  /*!
+   * \brief Gives the genome of a creature to add().
+   */
+  utils::Handle addRandomGenome(uint64_t seed) { return genomes.addRandom(seed); }
+
+  /*!
+   * \brief Simulates all creatures up to tnow.
+   * \param tnow The time difference since the simulation started.
+   * \param scheduler Runs the chunks in parallel.
+   * \param plants The creatures graze the plants of their cell.
+   */
+  void update(tool::PreciseTime tnow, utils::TaskScheduler& scheduler, PlantPopulation& plants);
+
+  // [J/s] metabolism of a resting creature
+  static constexpr float BASE_METABOLISM = 1.f;
+  // [J s^2] additional metabolism per squared speed of a moving creature
+  static constexpr float MOVEMENT_METABOLISM = 1e8f;
+  // [kg/s] how much a creature eats if there is enough
+  static constexpr float FEEDING_RATE = 2e-4f;
+  // [J/kg]
+  static constexpr float ENERGY_PER_BIOMASS = 1e4f;
+  // [J] energy of a spawned creature
+  static constexpr float INITIAL_ENERGY = 1e3f;
+  // [J] a creature with a fertility gene of 0.5 reproduces above, half of its energy goes
+  // to the child
+  static constexpr float REPRODUCTION_ENERGY = 2.f * INITIAL_ENERGY;
+  // [1/s] speed of a MOBILE creature with a speed gene of 1
+  static constexpr float MAX_SPEED = 1e-4f;
+  // [rad] how far from its parent a child is placed at most
+  static constexpr float BIRTH_DISTANCE = 1e-3f;
+  // [rad] how far apart two parents may be to mate
+  static constexpr float MATING_DISTANCE = 1e-2f;
+
+ private:
+  // Where the components of an entity live.
+  struct Location {
+    uint32_t chunk;
+    uint32_t row;
+  };
+
+  void feed(CreatureChunk& chunk, double dt, PlantPopulation& plants);
+  void removeStarved(uint32_t chunk);
+  void reproduce(utils::TaskScheduler& scheduler, tool::PreciseTime t);
+
+  utils::HandlePool pool;
+  std::vector<Location> locations;
+  // Chunks never move in memory and are never deleted, an empty chunk is reused.
+  std::vector<std::unique_ptr<CreatureChunk>> chunks;
+  // per archetype: chunks which are not full
+  std::vector<uint32_t> chunks_with_space[NUM_CREATURE_ARCHETYPES];
+  GenomeArena genomes;
+  uint32_t num_cells = 1;
+  tool::PreciseTime t_last_update = tool::PreciseTime();
+  uint64_t num_updates = 0;
+
+  static constexpr size_t PARENTS_PER_TASK = 1024;
+
+  // reused by reproduce()
+  std::vector<Creature> parents;
+  SpatialIndex parent_index = SpatialIndex(MATING_DISTANCE);
+  std::vector<GenomeArena::Birth> births;
+  std::vector<utils::Handle> children;
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "cubedSphere.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double QUARTER_PI = 0.78539816339744831;
+
+// The normal of a face and its column (u) and row (v) axes, u x v = normal.
+struct Face {
+  Eigen::Vector3f normal;
+  Eigen::Vector3f u;
+  Eigen::Vector3f v;
+};
+
+const Face FACES[6] = {
+    {Eigen::Vector3f(1, 0, 0), Eigen::Vector3f(0, 1, 0), Eigen::Vector3f(0, 0, 1)},
+    {Eigen::Vector3f(-1, 0, 0), Eigen::Vector3f(0, -1, 0), Eigen::Vector3f(0, 0, 1)},
+    {Eigen::Vector3f(0, 1, 0), Eigen::Vector3f(-1, 0, 0), Eigen::Vector3f(0, 0, 1)},
+    {Eigen::Vector3f(0, -1, 0), Eigen::Vector3f(1, 0, 0), Eigen::Vector3f(0, 0, 1)},
+    {Eigen::Vector3f(0, 0, 1), Eigen::Vector3f(0, 1, 0), Eigen::Vector3f(-1, 0, 0)},
+    {Eigen::Vector3f(0, 0, -1), Eigen::Vector3f(0, 1, 0), Eigen::Vector3f(1, 0, 0)}};
+
+// the face whose normal is closest to the position
+size_t getFace(const Eigen::Vector3f& position) {
+  size_t face = 0;
+  float best = FACES[0].normal.dot(position);
+  for (size_t f = 1; f < 6; f++) {
+    const float d = FACES[f].normal.dot(position);
+    if (d > best) {
+      best = d;
+      face = f;
+    }
+  }
+  return face;
+}
+
+// The kernels get their arrays as restrict parameters, else GCC does not vectorize them.
+void smoothRow(size_t n,
+               const double* __restrict center,
+               const double* __restrict left,
+               const double* __restrict right,
+               const double* __restrict down,
+               const double* __restrict up,
+               double* __restrict result,
+               double weight) {
+  for (size_t j = 0; j < n; j++) {
+    result[j] = center[j] + weight * (left[j] + right[j] + down[j] + up[j] - 4. * center[j]);
+  }
+}
+}  // namespace
+
+void CubedSphere::build(size_t face_size, size_t tile_size) {
+  this->tile_size = std::max<size_t>(1, tile_size);
+  tiles_per_face = std::max<size_t>(1, (face_size + this->tile_size - 1) / this->tile_size);
+  this->face_size = tiles_per_face * this->tile_size;
+
+  // The ghost cells along the 4 edges of every tile. The source is the cell containing a point
+  // just behind the middle of the edge the ghost shares with the tile. Across the edge of a
+  // face this is the cell of the other face sharing the edge, in whatever orientation the
+  // face has, since the equiangular cells line up along the edges of the faces.
+  const size_t num_tiles = getNumTiles();
+  halo_begin.assign(num_tiles + 1, 0);
+  halo_targets.clear();
+  halo_sources.clear();
+  halo_targets.reserve(num_tiles * 4 * this->tile_size);
+  halo_sources.reserve(num_tiles * 4 * this->tile_size);
+  for (size_t t = 0; t < num_tiles; t++) {
+    size_t face, first_column, first_row;
+    getTileOrigin(t, face, first_column, first_row);
+    // the ghost cell and the point in cells of the tile, a tenth of a cell behind the edge
+    const auto add = [&](int column, int row, double point_column, double point_row) {
+      halo_targets.push_back(static_cast<uint32_t>(getIndex(t, column, row)));
+      const Eigen::Vector3f point = getPoint(face,
+                                             static_cast<double>(first_column) + point_column,
+                                             static_cast<double>(first_row) + point_row);
+      halo_sources.push_back(static_cast<uint32_t>(getIndex(point)));
+    };
+    const int n = static_cast<int>(this->tile_size);
+    for (int k = 0; k < n; k++) {
+      const double middle = k + 0.5;
+      add(k, -1, middle, -0.1);
+      add(k, n, middle, n + 0.1);
+      add(-1, k, -0.1, middle);
+      add(n, k, n + 0.1, middle);
+    }
+    halo_begin[t + 1] = halo_targets.size();
+  }
+}
+
+void CubedSphere::getTileOrigin(size_t tile,
+                                size_t& face,
+                                size_t& column,
+                                size_t& row) const {
+  const size_t tiles = tiles_per_face * tiles_per_face;
+  face = tile / tiles;
+  const size_t in_face = tile % tiles;
+  column = (in_face % tiles_per_face) * tile_size;
+  row = (in_face / tiles_per_face) * tile_size;
+}
+
+Eigen::Vector3f CubedSphere::getCellCenter(size_t face, long column, long row) const {
+  return getPoint(face, static_cast<double>(column) + 0.5, static_cast<double>(row) + 0.5);
+}
+
+Eigen::Vector3f CubedSphere::getPoint(size_t face, double column, double row) const {
+  const double angle = 2. * QUARTER_PI / static_cast<double>(face_size);
+  const double a = -QUARTER_PI + column * angle;
+  const double b = -QUARTER_PI + row * angle;
+  const Face& f = FACES[face];
+  const float tan_a = static_cast<float>(std::tan(a));
+  const float tan_b = static_cast<float>(std::tan(b));
+  return (f.normal + tan_a * f.u + tan_b * f.v).normalized();
+}
+
+size_t CubedSphere::getIndex(const Eigen::Vector3f& position) const {
+  const size_t face = getFace(position);
+  const Face& f = FACES[face];
+  const double d = f.normal.dot(position);
+  const double to_cell = static_cast<double>(face_size) / (2. * QUARTER_PI);
+  const auto toCell = [&](const Eigen::Vector3f& axis) {
+    const double cell = (std::atan(axis.dot(position) / d) + QUARTER_PI) * to_cell;
+    return std::min(face_size - 1, static_cast<size_t>(std::max(0., cell)));
+  };
+  const size_t column = toCell(f.u);
+  const size_t row = toCell(f.v);
+  const size_t tile = face * tiles_per_face * tiles_per_face +
+                      (row / tile_size) * tiles_per_face + column / tile_size;
+  return getIndex(
+      tile, static_cast<int>(column % tile_size), static_cast<int>(row % tile_size));
+}
+
+void CubedSphere::exchangeHalos(double* field, utils::TaskScheduler& scheduler) const {
+  const uint32_t* targets = halo_targets.data();
+  const uint32_t* sources = halo_sources.data();
+  scheduler.parallelFor(getNumTiles(), [&](size_t t) {
+    for (size_t k = halo_begin[t]; k < halo_begin[t + 1]; k++) {
+      field[targets[k]] = field[sources[k]];
+    }
+  });
+}
+
+void CubedSphere::smooth(const double* values,
+                         double* result,
+                         double rate,
+                         utils::TaskScheduler& scheduler) const {
+  const size_t stride = getStride();
+  const double weight = 0.25 * rate;
+  scheduler.parallelFor(getNumTiles(), [&](size_t t) {
+    for (size_t row = 0; row < tile_size; row++) {
+      const size_t first = getIndex(t, 0, static_cast<int>(row));
+      smoothRow(tile_size,
+                values + first,
+                values + first - 1,
+                values + first + 1,
+                values + first - stride,
+                values + first + stride,
+                result + first,
+                weight);
+    }
+  });
+}
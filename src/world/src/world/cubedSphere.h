@@ -0,0 +1,113 @@
+#ifndef CUBED_SPHERE
+#define CUBED_SPHERE
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+/*!
+ * \brief The sphere as the 6 faces of a cube, each face_size * face_size cells of equal angle
+ * (equiangular gnomonic projection), such that the cells differ in size by less than 1.5x and
+ * every cell has 4 neighbours in rows and columns, also across the edges of the faces.
+ * The faces are split into square tiles of tile_size * tile_size cells. A field stores each
+ * tile on its own together with a ring of ghost cells: copies of the cells of the neighbouring
+ * tiles, possibly of another face. Thus a 5 point stencil on a tile only reads the tile's
+ * memory, one thread updates a tile while it stays in its L2 cache, and the tiles run in
+ * parallel without sharing cache lines. exchangeHalos() refreshes the ghost cells afterwards
+ * in a separate pass which only copies 4 * tile_size values per tile along a precomputed
+ * table. The 4 corner ghosts of a tile are not part of any 5 point stencil and stay unset.
+ */
+class CubedSphere {
+ public:
+  CubedSphere() = default;
+
+  /*!
+   * \param face_size Cells along the edge of a face, rounded up to a multiple of tile_size.
+   * \param tile_size Cells along the edge of a tile, e.g. 64: 66 * 66 doubles of 8 fields
+   * fit into a 512 KiB L2 cache.
+   */
+  CubedSphere(size_t face_size, size_t tile_size) { build(face_size, tile_size); }
+
+  void build(size_t face_size, size_t tile_size);
+
+  size_t getFaceSize() const { return face_size; }
+  size_t getTileSize() const { return tile_size; }
+  size_t getNumTiles() const { return 6 * tiles_per_face * tiles_per_face; }
+  size_t getNumCells() const { return 6 * face_size * face_size; }
+
+  /*!
+   * \brief The distance of two rows of a tile in a field, tile_size + 2.
+   */
+  size_t getStride() const { return tile_size + 2; }
+
+  /*!
+   * \brief The number of values of a field: getNumTiles() * getStride()^2.
+   */
+  size_t getFieldSize() const { return getNumTiles() * getStride() * getStride(); }
+
+  /*!
+   * \brief Where a cell of a tile is in a field.
+   * \param column, row In [0, tile_size) for the cells of the tile, -1 and tile_size for its
+   * ghost cells.
+   */
+  size_t getIndex(size_t tile, int column, int row) const {
+    return tile * getStride() * getStride() + static_cast<size_t>(row + 1) * getStride() +
+           static_cast<size_t>(column + 1);
+  }
+
+  /*!
+   * \brief The face a tile belongs to and the face cell of the tile's first cell.
+   */
+  void getTileOrigin(size_t tile, size_t& face, size_t& column, size_t& row) const;
+
+  /*!
+   * \brief The center of a face cell on the unit sphere. Columns and rows outside of
+   * [0, face_size) give points beyond the edge of the face, on the neighbouring face.
+   */
+  Eigen::Vector3f getCellCenter(size_t face, long column, long row) const;
+
+  /*!
+   * \brief The index in a field of the cell containing a position on the unit sphere.
+   */
+  size_t getIndex(const Eigen::Vector3f& position) const;
+
+  /*!
+   * \brief Copies the cells next to the edges of every tile into the ghost cells of its
+   * neighbours. Tiles run in parallel, each writes only its own ghost cells.
+   * \param field getFieldSize() values.
+   */
+  void exchangeHalos(double* field, utils::TaskScheduler& scheduler) const;
+
+  /*!
+   * \brief One explicit diffusion step on the 4 neighbours of every cell, tile by tile:
+   * result = values + rate * (mean of the neighbours - values). Needs the ghost cells of
+   * values, leaves the ghost cells of result unset.
+   * \param values, result getFieldSize() values each.
+   * \param rate In [0, 1].
+   */
+  void smooth(const double* values,
+              double* result,
+              double rate,
+              utils::TaskScheduler& scheduler) const;
+
+ private:
+  /*!
+   * \brief A point on the unit sphere in cell units of a face: the cell (c, r) spans
+   * [c, c + 1) x [r, r + 1). Outside of [0, face_size) the points are beyond the edge of the
+   * face.
+   */
+  Eigen::Vector3f getPoint(size_t face, double column, double row) const;
+
+  size_t face_size = 0;
+  size_t tile_size = 0;
+  size_t tiles_per_face = 0;
+  // The ghost cells of tile t are halo_targets[halo_begin[t], halo_begin[t + 1]), filled
+  // from the field indices in halo_sources.
+  std::vector<size_t> halo_begin;
+  std::vector<uint32_t> halo_targets;
+  std::vector<uint32_t> halo_sources;
+};
+
+#endif
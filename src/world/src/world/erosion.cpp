@@ -0,0 +1,219 @@
+#include "erosion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utils/atomic.hpp>
+#include <utils/hash.hpp>
+#include <vector>
+
+#include "gridGeometry.h"
+
+namespace {
+
+// The random numbers of one batch of droplets.
+class RandomStream {
+ public:
+  RandomStream(uint64_t seed, uint64_t stream) : state(utils::hash(seed ^ utils::hash(stream))) {}
+
+  // [0, 1)
+  double next() {
+    return static_cast<double>(utils::hash(state++) >> 11) * (1. / (uint64_t(1) << 53));
+  }
+
+ private:
+  uint64_t state;
+};
+
+// The height field around a position, interpolated bilinearly between the 4 closest cells.
+struct Sample {
+  size_t cells[4];
+  double weights[4];
+  double height;
+  // per column and per row
+  double gradient_u;
+  double gradient_v;
+};
+
+class HeightField {
+ public:
+  HeightField(double* height, const float* strength, size_t num_cells)
+      : height(height),
+        strength(strength),
+        rows(GridGeometry::getNumRows(static_cast<uint32_t>(num_cells))),
+        columns(GridGeometry::getNumColumns(static_cast<uint32_t>(num_cells))) {}
+
+  // u in [0, columns) and v in [0, rows - 1), cell centers are at whole numbers.
+  bool isInside(double v) const { return v >= 0. && v < static_cast<double>(rows - 1); }
+
+  double wrap(double u) const {
+    const double width = static_cast<double>(columns);
+    if (u < 0.) {
+      return u + width;
+    }
+    return (u >= width) ? u - width : u;
+  }
+
+  Sample sample(double u, double v) const {
+    const size_t c0 = std::min(static_cast<size_t>(u), columns - 1);
+    const size_t r0 = static_cast<size_t>(v);
+    const size_t c1 = (c0 + 1 == columns) ? 0 : c0 + 1;
+    const double fu = u - static_cast<double>(c0);
+    const double fv = v - static_cast<double>(r0);
+
+    Sample s;
+    s.cells[0] = r0 * columns + c0;
+    s.cells[1] = r0 * columns + c1;
+    s.cells[2] = (r0 + 1) * columns + c0;
+    s.cells[3] = (r0 + 1) * columns + c1;
+    s.weights[0] = (1. - fu) * (1. - fv);
+    s.weights[1] = fu * (1. - fv);
+    s.weights[2] = (1. - fu) * fv;
+    s.weights[3] = fu * fv;
+    double h[4];
+    s.height = 0.;
+    for (int i = 0; i < 4; i++) {
+      h[i] = utils::atomicLoad(height + s.cells[i]);
+      s.height += s.weights[i] * h[i];
+    }
+    s.gradient_u = (h[1] - h[0]) * (1. - fv) + (h[3] - h[2]) * fv;
+    s.gradient_v = (h[2] - h[0]) * (1. - fu) + (h[3] - h[1]) * fu;
+    return s;
+  }
+
+  // Spreads amount [m] over the cells of the sample.
+  void add(const Sample& s, double amount) const {
+    for (int i = 0; i < 4; i++) {
+      utils::atomicAdd(height + s.cells[i], amount * s.weights[i]);
+    }
+  }
+
+  double getStrength(const Sample& s) const {
+    return (strength == nullptr) ? 1. : static_cast<double>(strength[s.cells[0]]);
+  }
+
+  size_t getNumColumns() const { return columns; }
+  size_t getNumRows() const { return rows; }
+
+ private:
+  double* height;
+  const float* strength;
+  size_t rows;
+  size_t columns;
+};
+
+// Runs one droplet, returns its number of steps.
+size_t runDroplet(const HeightField& field,
+                  const erosion::Parameters& p,
+                  RandomStream& random) {
+  // Droplets only start on land, a few tries to find some.
+  constexpr int MAX_START_TRIES = 8;
+  double u = 0.;
+  double v = 0.;
+  bool on_land = false;
+  for (int i = 0; i < MAX_START_TRIES && !on_land; i++) {
+    u = random.next() * static_cast<double>(field.getNumColumns());
+    v = random.next() * static_cast<double>(field.getNumRows() - 1);
+    on_land = field.sample(u, v).height >= p.sea_level;
+  }
+  if (!on_land) {
+    return 0;
+  }
+
+  double direction_u = 0.;
+  double direction_v = 0.;
+  double speed = 1.;
+  double water = 1.;
+  // [height_unit]
+  double sediment = 0.;
+  const double min_slope = p.min_slope / p.height_unit;
+  size_t step = 0;
+  for (; step < static_cast<size_t>(p.max_steps); step++) {
+    const Sample here = field.sample(u, v);
+    direction_u = direction_u * p.inertia - here.gradient_u * (1. - p.inertia);
+    direction_v = direction_v * p.inertia - here.gradient_v * (1. - p.inertia);
+    const double length = std::sqrt(direction_u * direction_u + direction_v * direction_v);
+    if (length < 1e-12) {
+      break;
+    }
+    direction_u /= length;
+    direction_v /= length;
+    const double next_u = field.wrap(u + direction_u);
+    const double next_v = v + direction_v;
+    if (!field.isInside(next_v)) {
+      // too close to a pole
+      break;
+    }
+
+    const double next_height = field.sample(next_u, next_v).height;
+    if (next_height < p.sea_level) {
+      // The river mouth gets all the sediment.
+      field.add(here, sediment * p.height_unit);
+      sediment = 0.;
+      break;
+    }
+    const double delta = (next_height - here.height) / p.height_unit;
+    const double capacity = std::max(-delta, min_slope) * speed * water * p.capacity;
+    if (sediment > capacity || delta > 0.) {
+      // Uphill the droplet fills the pit behind it, else it drops a part of the excess.
+      const double amount =
+          (delta > 0.) ? std::min(delta, sediment) : (sediment - capacity) * p.deposition;
+      sediment -= amount;
+      field.add(here, amount * p.height_unit);
+    } else {
+      // Never erodes deeper than the next position, that would dig a pit.
+      const double amount =
+          std::min((capacity - sediment) * p.erosion * field.getStrength(here), -delta);
+      sediment += amount;
+      field.add(here, -amount * p.height_unit);
+    }
+
+    speed = std::sqrt(std::max(0., speed * speed - delta * p.gravity));
+    water *= 1. - p.evaporation;
+    u = next_u;
+    v = next_v;
+  }
+  // What is left settles where the droplet dried up, no material is lost.
+  if (sediment > 0.) {
+    field.add(field.sample(u, v), sediment * p.height_unit);
+  }
+  return step;
+}
+}  // namespace
+
+namespace erosion {
+
+Stats erode(double* height,
+            const float* strength,
+            size_t num_cells,
+            size_t num_droplets,
+            uint64_t seed,
+            utils::TaskScheduler& scheduler,
+            const Parameters& parameters) {
+  const auto start = std::chrono::steady_clock::now();
+  Stats stats;
+  const HeightField field(height, strength, num_cells);
+  if (field.getNumRows() < 2) {
+    return stats;
+  }
+
+  const size_t num_tasks = (num_droplets + DROPLETS_PER_TASK - 1) / DROPLETS_PER_TASK;
+  std::vector<size_t> steps(num_tasks, 0);
+  scheduler.parallelFor(num_tasks, [&](size_t task) {
+    RandomStream random(seed, task);
+    const size_t end = std::min(num_droplets, (task + 1) * DROPLETS_PER_TASK);
+    size_t task_steps = 0;
+    for (size_t d = task * DROPLETS_PER_TASK; d < end; d++) {
+      task_steps += runDroplet(field, parameters, random);
+    }
+    steps[task] = task_steps;
+  });
+
+  stats.num_droplets = num_droplets;
+  for (const size_t s : steps) {
+    stats.num_steps += s;
+  }
+  stats.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+}  // namespace erosion
@@ -0,0 +1,82 @@
+#ifndef EROSION
+#define EROSION
+
+#include <cstddef>
+#include <cstdint>
+#include <utils/taskScheduler.hpp>
+
+/*!
+ * \brief Hydraulic erosion by droplets: each droplet starts on land, runs downhill over the
+ * height field, takes up sediment where it speeds up and drops it where it slows down or
+ * reaches the sea. Rivers carve valleys and sinks fill up to lakes.
+ * The height field is the one of a CellGrid laid out as in GridGeometry, droplets move on
+ * the rows and columns (wrapping around in longitude).
+ * Droplets run in parallel, all threads change the one height field with atomic adds. Since
+ * concurrent droplets see each others changes in varying order, the result is only
+ * reproducible with one thread. Every batch of droplets draws its random numbers from its
+ * own stream, independent of the thread running it.
+ */
+namespace erosion {
+
+// how the terrain of a new world is eroded
+enum Solver { DROPLET_SOLVER, SHALLOW_WATER_SOLVER };
+
+struct Parameters {
+  // [m] cells below do not erode, droplets which reach them end
+  double sea_level = 0.;
+  // how much a droplet keeps its direction instead of following the slope, [0, 1)
+  double inertia = 0.05;
+  // sediment a droplet can carry per slope, speed and water
+  double capacity = 4.;
+  // [m] lower bound of the slope used for the capacity, droplets keep eroding on flat land
+  double min_slope = 1.;
+  // fraction of the free capacity eroded and of the excess sediment dropped per step
+  double erosion = 0.3;
+  double deposition = 0.3;
+  // fraction of the water evaporating per step
+  double evaporation = 0.02;
+  double gravity = 4.;
+  int max_steps = 64;
+  // [m] the heights in the formulas above are divided by it
+  double height_unit = 100.;
+};
+
+struct Stats {
+  size_t num_droplets = 0;
+  // steps of all droplets, or of the grid for ShallowWater
+  size_t num_steps = 0;
+  // steps times cells, only ShallowWater
+  size_t num_cell_updates = 0;
+  // [s]
+  double duration = 0.;
+
+  double getDropletsPerSecond() const {
+    return (duration > 0.) ? static_cast<double>(num_droplets) / duration : 0.;
+  }
+
+  double getCellUpdatesPerSecond() const {
+    return (duration > 0.) ? static_cast<double>(num_cell_updates) / duration : 0.;
+  }
+};
+
+/*!
+ * \brief Runs num_droplets droplets over the height field.
+ * \param height [m] num_cells heights, changed in place.
+ * \param strength Per cell factor of the erosion (e.g. by area type), nullptr for 1 everywhere.
+ * \param num_droplets The number of droplets.
+ * \param seed Where the droplets start.
+ * \param scheduler Runs batches of DROPLETS_PER_TASK droplets in parallel.
+ * \param parameters How the droplets erode.
+ */
+Stats erode(double* height,
+            const float* strength,
+            size_t num_cells,
+            size_t num_droplets,
+            uint64_t seed,
+            utils::TaskScheduler& scheduler,
+            const Parameters& parameters = Parameters());
+
+constexpr size_t DROPLETS_PER_TASK = 4096;
+}  // namespace erosion
+
+#endif
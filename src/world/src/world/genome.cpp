@@ -0,0 +1,95 @@
+#include "genome.h"
+
+#include <algorithm>
+#include <utils/hash.hpp>
+
+namespace {
+// All bits from bit on, clamped to the word.
+uint64_t bitsFrom(int bit) {
+  if (bit <= 0) {
+    return ~0ull;
+  }
+  if (bit >= 64) {
+    return 0ull;
+  }
+  return ~0ull << bit;
+}
+}  // namespace
+
+void GenomeArena::reserve(size_t num_genomes) {
+  pool.reserve(num_genomes);
+  words.reserve(num_genomes * GENOME_WORDS);
+}
+
+utils::Handle GenomeArena::addRandom(uint64_t seed) {
+  const utils::Handle genome = pool.create();
+  words.resize(pool.getNumSlots() * GENOME_WORDS);
+  uint64_t* bits = words.data() + genome.index * GENOME_WORDS;
+  for (size_t w = 0; w < GENOME_WORDS; w++) {
+    bits[w] = utils::hash(seed ^ utils::hash(w));
+  }
+  return genome;
+}
+
+bool GenomeArena::remove(const utils::Handle& genome) { return pool.destroy(genome); }
+
+float GenomeArena::getGene(const utils::Handle& genome, Gene gene) const {
+  constexpr uint64_t MAX = (1ull << GENE_BITS) - 1;
+  const size_t bit = static_cast<size_t>(gene) * GENE_BITS;
+  const uint64_t value = (get(genome)[bit / 64] >> (bit % 64)) & MAX;
+  return static_cast<float>(value) / static_cast<float>(MAX);
+}
+
+void GenomeArena::reproduce(const std::vector<Birth>& births,
+                            std::vector<utils::Handle>& children,
+                            utils::TaskScheduler& scheduler,
+                            uint64_t seed) {
+  // The pool and the array are not thread safe: allocate all children first, afterwards
+  // every task only writes the slots of its own children.
+  children.resize(births.size());
+  for (auto& child : children) {
+    child = pool.create();
+  }
+  words.resize(pool.getNumSlots() * GENOME_WORDS);
+
+  const size_t num_tasks = (births.size() + BIRTHS_PER_TASK - 1) / BIRTHS_PER_TASK;
+  scheduler.parallelFor(num_tasks, [this, &births, &children, seed](size_t task) {
+    const size_t end = std::min(births.size(), (task + 1) * BIRTHS_PER_TASK);
+    for (size_t i = task * BIRTHS_PER_TASK; i < end; i++) {
+      uint64_t* child = words.data() + children[i].index * GENOME_WORDS;
+      const uint64_t r = utils::hash(seed ^ utils::hash(i));
+      crossover(get(births[i].parent_a), get(births[i].parent_b), child, r);
+      mutate(child, r + 1);
+    }
+  });
+}
+
+void GenomeArena::mutate(uint64_t* genome, uint64_t seed) {
+  uint64_t r = utils::hash(seed);
+  for (size_t w = 0; w < GENOME_WORDS; w++) {
+    // Every bit of the AND of n random words is set with probability 2^-n.
+    uint64_t flip = ~0ull;
+    for (int i = 0; i < MUTATION_RATE_LOG2; i++) {
+      flip &= utils::hash(r++);
+    }
+    genome[w] ^= flip;
+  }
+}
+
+void GenomeArena::crossover(const uint64_t* a,
+                            const uint64_t* b,
+                            uint64_t* child,
+                            uint64_t seed) {
+  const uint64_t r = utils::hash(seed);
+  const int first = static_cast<int>(r % GENOME_BITS);
+  const int last = static_cast<int>((r >> 32) % GENOME_BITS);
+  const int begin = std::min(first, last);
+  const int end = std::max(first, last);
+  // With first > last the range of b wraps around the end of the genome.
+  const uint64_t invert = (first > last) ? ~0ull : 0ull;
+  for (size_t w = 0; w < GENOME_WORDS; w++) {
+    const int offset = static_cast<int>(w * 64);
+    const uint64_t from_b = (bitsFrom(begin - offset) & ~bitsFrom(end - offset)) ^ invert;
+    child[w] = a[w] ^ ((a[w] ^ b[w]) & from_b);
+  }
+}
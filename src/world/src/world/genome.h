@@ -0,0 +1,102 @@
+#ifndef GENOME
+#define GENOME
+
+#include <cstddef>
+#include <cstdint>
+#include <utils/handlePool.hpp>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+// Genes are GENE_BITS wide fields of the genome, read as fraction of their maximum.
+enum Gene { GENE_SPEED, GENE_FERTILITY, NUM_GENES };
+
+/*!
+ * \brief All genomes of the world as bit-packed blobs of GENOME_WORDS words in one array.
+ * Mutation and crossover work on whole words with bitwise operations, no gene is touched
+ * on its own. Slots are handed out by a HandlePool, thus the array only grows if there are
+ * more genomes than ever before.
+ */
+class GenomeArena {
+ public:
+  static constexpr size_t GENOME_WORDS = 8;
+  static constexpr size_t GENOME_BITS = GENOME_WORDS * 64;
+  static constexpr size_t GENE_BITS = 8;
+  // Every bit flips with a probability of 2^-MUTATION_RATE_LOG2 per mutate().
+  static constexpr int MUTATION_RATE_LOG2 = 8;
+
+  // One requested child, see reproduce().
+  struct Birth {
+    utils::Handle parent_a;
+    utils::Handle parent_b;
+  };
+
+  void reserve(size_t num_genomes);
+
+  /*!
+   * \brief Adds a genome with random bits.
+   * \param seed Different seeds give different genomes.
+   */
+  utils::Handle addRandom(uint64_t seed);
+
+  /*!
+   * \return False if the genome was already removed.
+   */
+  bool remove(const utils::Handle& genome);
+
+  /*!
+   * \brief Removes all genomes, the memory is kept.
+   */
+  void clear() { pool.clear(); }
+
+  bool isAlive(const utils::Handle& genome) const { return pool.isAlive(genome); }
+
+  size_t size() const { return pool.size(); }
+
+  const uint64_t* get(const utils::Handle& genome) const {
+    return words.data() + genome.index * GENOME_WORDS;
+  }
+
+  /*!
+   * \return The gene in [0, 1].
+   */
+  float getGene(const utils::Handle& genome, Gene gene) const;
+
+  /*!
+   * \brief Creates one child per birth: a crossover of both parents, then mutated.
+   * The slots are allocated up front, then all children are created in parallel.
+   * \param births The parents, a parent may be given as both parents (mutated clone).
+   * \param children Receives the handle of the child of each birth.
+   * \param scheduler Creates the children in parallel.
+   * \param seed Different seeds give different children.
+   */
+  void reproduce(const std::vector<Birth>& births,
+                 std::vector<utils::Handle>& children,
+                 utils::TaskScheduler& scheduler,
+                 uint64_t seed);
+
+  /*!
+   * \brief Flips every bit with a probability of 2^-MUTATION_RATE_LOG2.
+   * \param genome GENOME_WORDS words.
+   * \param seed Different seeds give different mutations.
+   */
+  static void mutate(uint64_t* genome, uint64_t seed);
+
+  /*!
+   * \brief Two point crossover: the child is a copy of a with a random range of bits
+   * (possibly wrapping around the end) from b.
+   * \param a, b, child GENOME_WORDS words each, child may be a or b.
+   * \param seed Different seeds give different crossover points.
+   */
+  static void crossover(const uint64_t* a, const uint64_t* b, uint64_t* child, uint64_t seed);
+
+ private:
+  utils::HandlePool pool;
+  std::vector<uint64_t> words;
+
+  // reused by reproduce()
+  std::vector<uint32_t> child_slots;
+
+  static constexpr size_t BIRTHS_PER_TASK = 1024;
+};
+
+#endif
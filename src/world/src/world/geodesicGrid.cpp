@@ -0,0 +1,148 @@
+#include "geodesicGrid.h"
+
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <utils/icosphere.hpp>
+
+namespace {
+
+constexpr int HILBERT_BITS = 10;
+
+/*!
+ * \brief The index of a point of the cube [-1, 1]^3 along a 3D Hilbert curve through a grid
+ * of 2^HILBERT_BITS cells per axis (J. Skilling, Programming the Hilbert curve, 2004).
+ */
+uint32_t getHilbertKey(const Eigen::Vector3f& position) {
+  constexpr uint32_t max = (1u << HILBERT_BITS) - 1;
+  uint32_t x[3];
+  for (int i = 0; i < 3; i++) {
+    const float unit = 0.5f * (position[i] + 1.f);
+    x[i] = std::min(max, static_cast<uint32_t>(std::max(0.f, unit) * (max + 1)));
+  }
+
+  // the axes to the transposed Hilbert index
+  for (uint32_t q = 1u << (HILBERT_BITS - 1); q > 1; q >>= 1) {
+    const uint32_t p = q - 1;
+    for (int i = 0; i < 3; i++) {
+      if (x[i] & q) {
+        x[0] ^= p;
+      } else {
+        const uint32_t t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+    }
+  }
+  for (int i = 1; i < 3; i++) {
+    x[i] ^= x[i - 1];
+  }
+  uint32_t t = 0;
+  for (uint32_t q = 1u << (HILBERT_BITS - 1); q > 1; q >>= 1) {
+    if (x[2] & q) {
+      t ^= q - 1;
+    }
+  }
+  for (int i = 0; i < 3; i++) {
+    x[i] ^= t;
+  }
+
+  // interleave the bits, the highest first
+  uint32_t key = 0;
+  for (int bit = HILBERT_BITS - 1; bit >= 0; bit--) {
+    for (int i = 0; i < 3; i++) {
+      key = (key << 1) | ((x[i] >> bit) & 1u);
+    }
+  }
+  return key;
+}
+
+// Sorts the neighbours of a vertex counterclockwise around it, seen from outside.
+void sortAround(const Eigen::Vector3f& center,
+                const std::vector<Eigen::Vector3f>& positions,
+                uint32_t* begin,
+                uint32_t* end) {
+  // any tangent works, it only sets where the circle starts
+  const Eigen::Vector3f helper =
+      (std::abs(center.x()) < 0.9f) ? Eigen::Vector3f::UnitX() : Eigen::Vector3f::UnitY();
+  const Eigen::Vector3f u = center.cross(helper).normalized();
+  const Eigen::Vector3f v = center.cross(u);
+  std::sort(begin, end, [&](uint32_t a, uint32_t b) {
+    const Eigen::Vector3f da = positions[a] - center;
+    const Eigen::Vector3f db = positions[b] - center;
+    return std::atan2(da.dot(v), da.dot(u)) < std::atan2(db.dot(v), db.dot(u));
+  });
+}
+}  // namespace
+
+size_t GeodesicGrid::getNumCells(unsigned int level) {
+  return utils::IcosphereLevel::getNumVertices(level);
+}
+
+void GeodesicGrid::build(unsigned int level, Ordering ordering) {
+  const utils::IcosphereLevel& sphere = utils::IcosphereLevel::get(level);
+  const size_t num_cells = sphere.getNumVertices();
+
+  // the neighbours of the vertices from the edges, every vertex has 5 or 6
+  std::vector<uint32_t> vertex_neighbours(num_cells * MAX_NEIGHBOURS);
+  std::vector<uint8_t> counts(num_cells, 0);
+  for (const std::array<uint32_t, 2>& edge : sphere.edges) {
+    vertex_neighbours[edge[0] * MAX_NEIGHBOURS + counts[edge[0]]++] = edge[1];
+    vertex_neighbours[edge[1] * MAX_NEIGHBOURS + counts[edge[1]]++] = edge[0];
+  }
+
+  vertices.resize(num_cells);
+  std::iota(vertices.begin(), vertices.end(), 0u);
+  if (ordering == HILBERT_ORDER) {
+    std::vector<uint32_t> keys(num_cells);
+    for (size_t i = 0; i < num_cells; i++) {
+      keys[i] = getHilbertKey(sphere.positions[i]);
+    }
+    // stable, vertices in the same Hilbert cell keep their order
+    std::stable_sort(vertices.begin(), vertices.end(), [&keys](uint32_t a, uint32_t b) {
+      return keys[a] < keys[b];
+    });
+  }
+  std::vector<int32_t> cell_of_vertex(num_cells);
+  for (size_t c = 0; c < num_cells; c++) {
+    cell_of_vertex[vertices[c]] = static_cast<int32_t>(c);
+  }
+
+  centers.resize(num_cells);
+  neighbours.resize(num_cells * MAX_NEIGHBOURS);
+  neighbour_weights.resize(num_cells);
+  for (size_t c = 0; c < num_cells; c++) {
+    const uint32_t vertex = vertices[c];
+    const int count = counts[vertex];
+    uint32_t* around = vertex_neighbours.data() + vertex * MAX_NEIGHBOURS;
+    sortAround(sphere.positions[vertex], sphere.positions, around, around + count);
+    centers[c] = sphere.positions[vertex];
+    for (int k = 0; k < MAX_NEIGHBOURS; k++) {
+      neighbours[c * MAX_NEIGHBOURS + k] =
+          (k < count) ? cell_of_vertex[around[k]] : static_cast<int32_t>(c);
+    }
+    neighbour_weights[c] = 1. / count;
+  }
+}
+
+void GeodesicGrid::smooth(const double* values,
+                          double* result,
+                          double rate,
+                          utils::TaskScheduler& scheduler) const {
+  const size_t num_cells = getNumCells();
+  const size_t num_tasks = (num_cells + CELLS_PER_TASK - 1) / CELLS_PER_TASK;
+  scheduler.parallelFor(num_tasks, [&](size_t task) {
+    const size_t begin = task * CELLS_PER_TASK;
+    const size_t end = std::min(num_cells, begin + CELLS_PER_TASK);
+    for (size_t c = begin; c < end; c++) {
+      const int32_t* n = neighbours.data() + c * MAX_NEIGHBOURS;
+      const double v = values[c];
+      // the 6th neighbour of a pentagon is the cell itself and adds v - v
+      const double sum = values[n[0]] + values[n[1]] + values[n[2]] + values[n[3]] +
+                         values[n[4]] + values[n[5]] - MAX_NEIGHBOURS * v;
+      result[c] = v + rate * neighbour_weights[c] * sum;
+    }
+  });
+}
@@ -0,0 +1,97 @@
+#ifndef GEODESIC_GRID
+#define GEODESIC_GRID
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+/*!
+ * \brief Cells of (nearly) equal size on the unit sphere without the crowded poles of the
+ * latitude rows of GridGeometry: the cells are the vertices of an icosphere (see
+ * utils::IcosphereLevel), each is a hexagon, except for the 12 corners of the icosahedron
+ * which are pentagons.
+ * The neighbours of all cells are one flat table of MAX_NEIGHBOURS indices per cell,
+ * counterclockwise seen from outside. The 6th neighbour of a pentagon is the cell itself, such
+ * that kernels loop over 6 neighbours without branches; differences to it are 0.
+ * The cells are numbered along a Hilbert curve through the cube around the sphere: a block
+ * of consecutive cells is a compact patch whose neighbours are mostly in the same block,
+ * thus the fields of a CellGrid with getNumCells() cells are walked cache friendly and the
+ * blocks of a parallelFor() touch little memory of other blocks.
+ */
+class GeodesicGrid {
+ public:
+  // How the cells are numbered.
+  enum Ordering { HILBERT_ORDER, ICOSPHERE_ORDER };
+
+  GeodesicGrid() = default;
+
+  explicit GeodesicGrid(unsigned int level, Ordering ordering = HILBERT_ORDER) {
+    build(level, ordering);
+  }
+
+  /*!
+   * \brief Builds the cells of the icosphere level, the former cells are removed.
+   * \param level Of the icosphere, see getNumCells(level).
+   * \param ordering ICOSPHERE_ORDER keeps the vertex order of the icosphere, for comparison.
+   */
+  void build(unsigned int level, Ordering ordering = HILBERT_ORDER);
+
+  /*!
+   * \brief The number of cells of a level without building it, 10 * 4^level + 2.
+   */
+  static size_t getNumCells(unsigned int level);
+
+  size_t getNumCells() const { return centers.size(); }
+
+  /*!
+   * \brief MAX_NEIGHBOURS cells, see the class description.
+   */
+  const int32_t* getNeighbours(size_t cell) const {
+    return neighbours.data() + cell * MAX_NEIGHBOURS;
+  }
+
+  // MAX_NEIGHBOURS per cell
+  const std::vector<int32_t>& getNeighbourTable() const { return neighbours; }
+
+  // 5 or 6
+  int getNumNeighbours(size_t cell) const {
+    return (neighbours[cell * MAX_NEIGHBOURS + MAX_NEIGHBOURS - 1] == static_cast<int32_t>(cell))
+               ? MAX_NEIGHBOURS - 1
+               : MAX_NEIGHBOURS;
+  }
+
+  // on the unit sphere
+  const Eigen::Vector3f& getCellCenter(size_t cell) const { return centers[cell]; }
+
+  /*!
+   * \brief The vertex of the icosphere level at the center of the cell, e.g. to draw the
+   * cells with the icosphere mesh.
+   */
+  uint32_t getVertex(size_t cell) const { return vertices[cell]; }
+
+  /*!
+   * \brief One explicit diffusion step: result = values + rate * (mean of the neighbours -
+   * values). Blocks of cells run in parallel.
+   * \param values, result getNumCells() values each, e.g. a field of a CellGrid.
+   * \param rate In [0, 1].
+   */
+  void smooth(const double* values,
+              double* result,
+              double rate,
+              utils::TaskScheduler& scheduler) const;
+
+  static constexpr int MAX_NEIGHBOURS = 6;
+
+ private:
+  std::vector<Eigen::Vector3f> centers;
+  std::vector<int32_t> neighbours;
+  // 1 / getNumNeighbours()
+  std::vector<double> neighbour_weights;
+  std::vector<uint32_t> vertices;
+
+  static constexpr size_t CELLS_PER_TASK = 8192;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#include "gridGeometry.h"
+
+Eigen::Vector3f GridGeometry::getCellCenter(uint32_t cell, uint32_t num_cells) {
+  float x;
+  float y;
+  float z;
+  getCellCenters(cell, cell + 1, num_cells, &x, &y, &z);
+  return Eigen::Vector3f(x, y, z);
+}
+
+void GridGeometry::getCellCenters(
+    size_t begin, size_t end, uint32_t num_cells, float* x, float* y, float* z) {
+  const uint32_t rows = getNumRows(num_cells);
+  const uint32_t columns = getNumColumns(num_cells);
+  const size_t last = static_cast<size_t>(rows) * columns - 1;
+  for (size_t c = begin; c < end; c++) {
+    const size_t cell = std::min(c, last);
+    const size_t row = cell / columns;
+    const size_t column = cell % columns;
+    const float center_z = (static_cast<float>(row) + 0.5f) / static_cast<float>(rows) * 2.f - 1.f;
+    const float longitude =
+        ((static_cast<float>(column) + 0.5f) / static_cast<float>(columns) - 0.5f) * 2.f * PI;
+    const float ring = std::sqrt(std::max(0.f, 1.f - center_z * center_z));
+    x[c - begin] = ring * std::cos(longitude);
+    y[c - begin] = ring * std::sin(longitude);
+    z[c - begin] = center_z;
+  }
+}
@@ -0,0 +1,57 @@
+#ifndef GRID_GEOMETRY
+#define GRID_GEOMETRY
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * \brief Where the cells of a CellGrid are on the unit sphere. The cells are latitude rows of
+ * longitude columns, indexed row by row from the south pole. Rows of equal height in z have
+ * equal area on the sphere (Archimedes), thus all cells have the same area and no asin is
+ * needed. num_cells is rounded down to rows * columns, the remaining cells are unused.
+ */
+class GridGeometry {
+ public:
+  /*!
+   * \brief The cell of a position on the unit sphere.
+   * \param num_cells The number of cells of the grid.
+   */
+  static uint32_t getCell(float x, float y, float z, uint32_t num_cells) {
+    const uint32_t rows = getNumRows(num_cells);
+    const uint32_t columns = getNumColumns(num_cells);
+    const float longitude = std::atan2(y, x);
+    const uint32_t row = std::min(rows - 1, static_cast<uint32_t>((0.5f * z + 0.5f) * rows));
+    const uint32_t column =
+        std::min(columns - 1, static_cast<uint32_t>((longitude / (2.f * PI) + 0.5f) * columns));
+    return row * columns + column;
+  }
+
+  /*!
+   * \brief The center of a cell on the unit sphere, see getCell(). Unused cells get the
+   * center of the last used one.
+   */
+  static Eigen::Vector3f getCellCenter(uint32_t cell, uint32_t num_cells);
+
+  /*!
+   * \brief The centers of the cells [begin, end) as structure of arrays.
+   * \param x, y, z Receive end - begin values each.
+   */
+  static void getCellCenters(
+      size_t begin, size_t end, uint32_t num_cells, float* x, float* y, float* z);
+
+  // rows * 2 rows = num_cells columns, rounded down
+  static uint32_t getNumRows(uint32_t num_cells) {
+    return std::max(1u, static_cast<uint32_t>(std::sqrt(0.5f * num_cells)));
+  }
+
+  static uint32_t getNumColumns(uint32_t num_cells) {
+    return std::max(1u, num_cells / getNumRows(num_cells));
+  }
+
+  static constexpr float PI = 3.14159265358979f;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef GRID_STENCIL
+#define GRID_STENCIL
+
+#include <cmath>
+#include <cstddef>
+
+/*!
+ * \brief Building blocks of the stencil kernels on the rows of a grid laid out as in
+ * GridGeometry: a row is split into spans whose neighbours are contiguous, the kernels get
+ * them as restrict pointers and loop over the span. This way GCC vectorizes the loops.
+ */
+namespace grid_stencil {
+
+/*!
+ * \brief Cells [begin, begin + n) of one row. The neighbours of cell begin + j are at
+ * left + j, right + j, down + j and up + j. Without a row below or above (at the poles)
+ * has_down or has_up is false and the missing row is the own one.
+ */
+struct Span {
+  size_t begin;
+  size_t n;
+  size_t left;
+  size_t right;
+  size_t down;
+  size_t up;
+  bool has_down;
+  bool has_up;
+};
+
+/*!
+ * \brief Calls kernel(Span) for the first cell, the inner cells and the last cell of one row,
+ * such that the neighbours of each span are contiguous despite the wrap around in longitude.
+ * \param first The index of the first cell of the row.
+ * \param columns The number of cells of the row, at least 2.
+ * \param down, up The index of the first cell of the row below and above.
+ */
+template <class Kernel>
+void forEachRowSpan(size_t first,
+                    size_t columns,
+                    size_t down,
+                    size_t up,
+                    bool has_down,
+                    bool has_up,
+                    const Kernel& kernel) {
+  const size_t last = first + columns - 1;
+  const size_t wrap = columns - 1;
+  kernel(Span{first, 1, last, first + 1, down, up, has_down, has_up});
+  kernel(Span{first + 1, columns - 2, first, first + 2, down + 1, up + 1, has_down, has_up});
+  kernel(Span{last, 1, last - 1, first, down + wrap, up + wrap, has_down, has_up});
+}
+
+// One array at the cells of a span and at their neighbours, see Span.
+struct Stencil {
+  const double* __restrict center;
+  const double* __restrict left;
+  const double* __restrict right;
+  const double* __restrict down;
+  const double* __restrict up;
+};
+
+inline Stencil getStencil(const double* values, const Span& s) {
+  return Stencil{
+      values + s.begin, values + s.left, values + s.right, values + s.down, values + s.up};
+}
+
+// Comparisons of computed values are selects which keep GCC from vectorizing the loops
+// (they could trap), the kernels use arithmetic instead.
+
+// max(x, 0)
+inline double positive(double x) { return 0.5 * (x + std::abs(x)); }
+
+inline double minimum(double a, double b) { return 0.5 * (a + b - std::abs(a - b)); }
+}  // namespace grid_stencil
+
+#endif
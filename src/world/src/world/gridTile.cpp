@@ -0,0 +1,19 @@
+#include "gridTile.h"
+
+#include <algorithm>
+#include <chrono>
+
+void GridTile::update(tool::PreciseTime tnow) {
+  const double dt = std::chrono::duration<double>(tnow - t_last_update).count();
+  const double change = grid->step(dt, begin, end);
+
+  // The slower the cells change the longer the next step may be, it grows at most by
+  // MAX_INTERVAL_GROWTH such that a sudden change is not stepped over.
+  double interval = MAX_UPDATE_INTERVAL;
+  if (change > 0.) {
+    interval = MAX_TEMPERATURE_CHANGE_K * dt / change;
+  }
+  interval = std::clamp(interval, 0., std::min(MAX_INTERVAL_GROWTH * dt, MAX_UPDATE_INTERVAL));
+  setUpdateIntervall(
+      std::chrono::duration_cast<tool::PreciseTime>(std::chrono::duration<double>(interval)));
+}
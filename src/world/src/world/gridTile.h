@@ -0,0 +1,38 @@
+#ifndef GRID_TILE
+#define GRID_TILE
+
+#include <cstddef>
+#include <utils/simulatedUnit.hpp>
+
+#include "cellGrid.h"
+
+/*!
+ * \brief A contiguous range of cells of the CellGrid which is simulated as one unit.
+ * Tiles never overlap, thus all tiles of one update can run in parallel.
+ * After every update the tile sets its update intervall such that its temperatures change
+ * by about MAX_TEMPERATURE_CHANGE_K per update: settled regions are updated rarely.
+ */
+class GridTile : public SimulatedUnit {
+ public:
+  GridTile(tool::PreciseTime t0, CellGrid* grid, size_t begin, size_t end)
+      : SimulatedUnit(t0), grid(grid), begin(begin), end(end) {}
+
+  size_t getBegin() const { return begin; }
+  size_t getEnd() const { return end; }
+
+ protected:
+  void update(tool::PreciseTime tnow) override;
+
+ private:
+  CellGrid* grid;
+  size_t begin;
+  size_t end;
+
+  // [K] per update
+  static constexpr double MAX_TEMPERATURE_CHANGE_K = 0.01;
+  // [s]
+  static constexpr double MAX_UPDATE_INTERVAL = 3600.;
+  static constexpr double MAX_INTERVAL_GROWTH = 2.;
+};
+
+#endif
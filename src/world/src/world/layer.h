@@ -28,6 +28,7 @@ class NutritionProperties : public Properties {
 };
 
 enum LayerTyp { AIR, WATER, GROUND };
+constexpr int NUM_LAYER_TYPES = 3;
 
 class Layer : public util::Settings {
  public:
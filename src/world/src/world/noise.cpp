@@ -0,0 +1,134 @@
+#include "noise.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Skewing between the simplex lattice and the cube lattice in 3D.
+constexpr float F3 = 1.f / 3.f;
+constexpr float G3 = 1.f / 6.f;
+// Scales the sum of the 4 corners to about [-1, 1].
+constexpr float SCALE = 32.f;
+
+int32_t fastFloor(float v) {
+  const int32_t i = static_cast<int32_t>(v);
+  return i - static_cast<int32_t>(v < static_cast<float>(i));
+}
+
+// 4 random bits per lattice point, integer arithmetic only.
+uint32_t hashCorner(int32_t i, int32_t j, int32_t k, uint32_t seed) {
+  uint32_t h = seed;
+  h ^= static_cast<uint32_t>(i) * 0x8da6b343u;
+  h ^= static_cast<uint32_t>(j) * 0xd8163841u;
+  h ^= static_cast<uint32_t>(k) * 0xcb1ab31fu;
+  h ^= h >> 15;
+  h *= 0x2c1b3c6du;
+  h ^= h >> 12;
+  h *= 0x297a2d39u;
+  return h >> 28;
+}
+
+// Dot product of one of 12 edge directions of a cube (Perlin) with (x, y, z), as selects.
+float gradient(uint32_t h, float x, float y, float z) {
+  const float u = (h < 8) ? x : y;
+  // h | 2 == 14: h is 12 or 14
+  const float v = (h < 4) ? y : (((h | 2) == 14) ? x : z);
+  const float sign_u = 1.f - 2.f * static_cast<float>(h & 1);
+  const float sign_v = 1.f - static_cast<float>(h & 2);
+  return sign_u * u + sign_v * v;
+}
+
+// The contribution of one simplex corner at the offset (x, y, z) to it.
+float corner(uint32_t h, float x, float y, float z) {
+  const float d = 0.6f - x * x - y * y - z * z;
+  // max(d, 0), a select here keeps GCC from vectorizing the loop
+  const float t = 0.5f * (d + std::abs(d));
+  const float t2 = t * t;
+  return t2 * t2 * gradient(h, x, y, z);
+}
+}  // namespace
+
+namespace noise {
+
+void addSimplex(size_t n,
+                const float* __restrict x,
+                const float* __restrict y,
+                const float* __restrict z,
+                float frequency,
+                float amplitude,
+                uint32_t seed,
+                float* __restrict result) {
+  const float scale = SCALE * amplitude;
+  for (size_t s = 0; s < n; s++) {
+    const float px = frequency * x[s];
+    const float py = frequency * y[s];
+    const float pz = frequency * z[s];
+
+    // the cube of the simplex lattice the sample is in
+    const float skew = (px + py + pz) * F3;
+    const int32_t i = fastFloor(px + skew);
+    const int32_t j = fastFloor(py + skew);
+    const int32_t k = fastFloor(pz + skew);
+    const float unskew = static_cast<float>(i + j + k) * G3;
+    const float x0 = px - (static_cast<float>(i) - unskew);
+    const float y0 = py - (static_cast<float>(j) - unskew);
+    const float z0 = pz - (static_cast<float>(k) - unskew);
+
+    // The rank of each offset decides which of the 6 simplices of the cube is the one,
+    // counted instead of branched.
+    const int32_t rank_x = (x0 >= y0) + (x0 >= z0);
+    const int32_t rank_y = (y0 > x0) + (y0 >= z0);
+    const int32_t rank_z = (z0 > x0) + (z0 > y0);
+    const int32_t i1 = rank_x >= 2;
+    const int32_t j1 = rank_y >= 2;
+    const int32_t k1 = rank_z >= 2;
+    const int32_t i2 = rank_x >= 1;
+    const int32_t j2 = rank_y >= 1;
+    const int32_t k2 = rank_z >= 1;
+
+    const float x1 = x0 - static_cast<float>(i1) + G3;
+    const float y1 = y0 - static_cast<float>(j1) + G3;
+    const float z1 = z0 - static_cast<float>(k1) + G3;
+    const float x2 = x0 - static_cast<float>(i2) + 2.f * G3;
+    const float y2 = y0 - static_cast<float>(j2) + 2.f * G3;
+    const float z2 = z0 - static_cast<float>(k2) + 2.f * G3;
+    const float x3 = x0 - 1.f + 3.f * G3;
+    const float y3 = y0 - 1.f + 3.f * G3;
+    const float z3 = z0 - 1.f + 3.f * G3;
+
+    const float sum = corner(hashCorner(i, j, k, seed), x0, y0, z0) +
+                      corner(hashCorner(i + i1, j + j1, k + k1, seed), x1, y1, z1) +
+                      corner(hashCorner(i + i2, j + j2, k + k2, seed), x2, y2, z2) +
+                      corner(hashCorner(i + 1, j + 1, k + 1, seed), x3, y3, z3);
+    result[s] += scale * sum;
+  }
+}
+
+void fractal(size_t n,
+             const float* x,
+             const float* y,
+             const float* z,
+             const Fractal& fractal,
+             uint32_t seed,
+             float* result) {
+  std::fill(result, result + n, 0.f);
+  float amplitude = 1.f;
+  float total_amplitude = 0.f;
+  for (int octave = 0; octave < fractal.octaves; octave++) {
+    total_amplitude += amplitude;
+    amplitude *= fractal.gain;
+  }
+  if (total_amplitude <= 0.f) {
+    return;
+  }
+
+  amplitude = 1.f / total_amplitude;
+  float frequency = fractal.frequency;
+  for (int octave = 0; octave < fractal.octaves; octave++) {
+    const uint32_t octave_seed = seed + static_cast<uint32_t>(octave) * 0x9e3779b9u;
+    addSimplex(n, x, y, z, frequency, amplitude, octave_seed, result);
+    frequency *= fractal.lacunarity;
+    amplitude *= fractal.gain;
+  }
+}
+}  // namespace noise
@@ -0,0 +1,65 @@
+#ifndef NOISE
+#define NOISE
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * \brief Coherent noise: 3D simplex noise and fractal sums of it (fBm).
+ * All functions work on arrays of positions (structure of arrays) and have no branches per
+ * sample, the compiler evaluates 4 (SSE) or 8 (AVX) samples at once. The gradients come from
+ * hashing the lattice point with the seed instead of a permutation table, thus the result
+ * only depends on seed and position: independent of how the samples are split into arrays
+ * or threads.
+ */
+namespace noise {
+
+/*!
+ * \brief Parameters of a fractal sum of octaves of simplex noise.
+ */
+struct Fractal {
+  int octaves = 8;
+  // of the first octave, per unit of the positions
+  float frequency = 1.f;
+  // frequency factor from one octave to the next
+  float lacunarity = 2.f;
+  // amplitude factor from one octave to the next
+  float gain = 0.5f;
+};
+
+/*!
+ * \brief Adds amplitude * simplex noise at frequency * position to result.
+ * \param n The number of samples.
+ * \param x, y, z The positions.
+ * \param frequency Scales the positions, the lattice has a spacing of 1.
+ * \param amplitude The noise in [-1, 1] is scaled by it.
+ * \param seed Different seeds give uncorrelated noise.
+ * \param result n values to add to.
+ */
+void addSimplex(size_t n,
+                const float* x,
+                const float* y,
+                const float* z,
+                float frequency,
+                float amplitude,
+                uint32_t seed,
+                float* result);
+
+/*!
+ * \brief Writes the fractal sum of octaves of simplex noise, normalized to [-1, 1].
+ * \param n The number of samples.
+ * \param x, y, z The positions.
+ * \param fractal The octaves.
+ * \param seed Different seeds give uncorrelated noise, every octave derives its own.
+ * \param result Receives n values.
+ */
+void fractal(size_t n,
+             const float* x,
+             const float* y,
+             const float* z,
+             const Fractal& fractal,
+             uint32_t seed,
+             float* result);
+}  // namespace noise
+
+#endif
@@ -1 +1,156 @@
 #include "plant.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utils/hash.hpp>
+
+#include "biome.h"
+
+void PlantPopulation::resize(size_t num_cells) {
+  pool.clear();
+  cells.clear();
+  biomass.clear();
+  age.clear();
+  cell_biomass.assign(num_cells, 0.f);
+  cell_grazing.assign(num_cells, 0.f);
+  // The births and deaths of the last update() refer to the removed plants.
+  chunk_changes.clear();
+}
+
+void PlantPopulation::reserve(size_t num_plants) {
+  pool.reserve(num_plants);
+  cells.reserve(num_plants);
+  biomass.reserve(num_plants);
+  age.reserve(num_plants);
+}
+
+utils::Handle PlantPopulation::add(uint32_t cell, float initial_biomass) {
+  const utils::Handle plant = pool.create();
+  if (plant.index >= cells.size()) {
+    cells.resize(pool.getNumSlots());
+    biomass.resize(pool.getNumSlots());
+    age.resize(pool.getNumSlots());
+  }
+  cells[plant.index] = cell;
+  biomass[plant.index] = initial_biomass;
+  age[plant.index] = 0.f;
+  cell_biomass[cell] += initial_biomass;
+  return plant;
+}
+
+void PlantPopulation::sow(size_t num_plants, uint64_t seed) {
+  if (cell_biomass.empty()) {
+    return;
+  }
+  std::vector<uint32_t> sow_cells(num_plants);
+  for (size_t i = 0; i < num_plants; i++) {
+    const uint64_t random = utils::hash(seed ^ utils::hash(i));
+    sow_cells[i] = static_cast<uint32_t>(random % cell_biomass.size());
+  }
+  // Neighboring slots in the same or nearby cells: update() accesses the cells in order.
+  std::sort(sow_cells.begin(), sow_cells.end());
+  reserve(size() + num_plants);
+  for (const uint32_t cell : sow_cells) {
+    add(cell, SEED_BIOMASS);
+  }
+}
+
+bool PlantPopulation::remove(const utils::Handle& plant) {
+  if (!pool.destroy(plant)) {
+    return false;
+  }
+  cell_biomass[cells[plant.index]] -= biomass[plant.index];
+  return true;
+}
+
+float PlantPopulation::graze(uint32_t cell, float amount) {
+  const float eaten = std::clamp(cell_biomass[cell] - cell_grazing[cell], 0.f, amount);
+  cell_grazing[cell] += eaten;
+  return eaten;
+}
+
+void PlantPopulation::update(double dt,
+                             const CellGrid& grid,
+                             utils::TaskScheduler& scheduler,
+                             uint64_t tick,
+                             const uint8_t* biomes) {
+  const size_t num_chunks = (pool.getNumSlots() + PLANTS_PER_CHUNK - 1) / PLANTS_PER_CHUNK;
+  if (chunk_changes.size() < num_chunks) {
+    chunk_changes.resize(num_chunks);
+  }
+  // Chunks only write their own plants and read the per cell data of the last step.
+  scheduler.parallelFor(num_chunks, [this, dt, &grid, tick, biomes](size_t c) {
+    updateChunk(c, dt, grid, tick, biomes);
+  });
+  applyChanges(num_chunks);
+}
+
+void PlantPopulation::updateChunk(
+    size_t chunk, double dt, const CellGrid& grid, uint64_t tick, const uint8_t* biomes) {
+  ChunkChanges& changes = chunk_changes[chunk];
+  changes.dead.clear();
+  changes.seed_cells.clear();
+
+  const float dt_f = static_cast<float>(dt);
+  const double* temperature = grid.getField(GROUND, TEMPERATURE);
+  const uint32_t num_cells = static_cast<uint32_t>(cell_biomass.size());
+  const size_t begin = chunk * PLANTS_PER_CHUNK;
+  const size_t end = std::min(begin + PLANTS_PER_CHUNK, pool.getNumSlots());
+  for (size_t i = begin; i < end; i++) {
+    if (!pool.isAlive(static_cast<uint32_t>(i))) {
+      continue;
+    }
+    const uint32_t cell = cells[i];
+    float mass = biomass[i];
+
+    // Grazing is shared among the plants of the cell by their biomass.
+    if (cell_grazing[cell] > 0.f && cell_biomass[cell] > 0.f) {
+      mass -= mass * std::min(cell_grazing[cell] / cell_biomass[cell], 1.f);
+    }
+
+    const float t = (static_cast<float>(temperature[cell]) - OPTIMAL_TEMPERATURE_K) /
+                    TEMPERATURE_TOLERANCE_K;
+    const float fertility = (biomes == nullptr) ? 1.f : biome::getFertility(biomes[cell]);
+    const float climate = std::max(1.f - t * t, 0.f) * fertility;
+    const float space = std::max(1.f - cell_biomass[cell] / CELL_CAPACITY, 0.f);
+    mass += dt_f * mass * (GROWTH_RATE * climate * space - UPKEEP_RATE);
+    age[i] += dt_f;
+
+    if (mass < MIN_BIOMASS || age[i] > MAX_AGE) {
+      changes.dead.push_back(static_cast<uint32_t>(i));
+    } else if (mass > SEEDING_BIOMASS) {
+      const uint64_t random = utils::hash(utils::hash(tick) ^ (static_cast<uint64_t>(i) << 20));
+      if (utils::toUnitFloat(random) < dt_f * SEED_RATE) {
+        mass -= SEED_BIOMASS;
+        const uint32_t distance = static_cast<uint32_t>(random % (2 * SEED_DISTANCE + 1));
+        // Cells are indexed along the surface, nearby indices are nearby cells.
+        changes.seed_cells.push_back((cell + num_cells + distance - SEED_DISTANCE) % num_cells);
+      }
+    }
+    biomass[i] = mass;
+  }
+}
+
+void PlantPopulation::applyChanges(size_t num_chunks) {
+  // More chunks than used are left from a larger population, their changes are outdated.
+  for (size_t c = 0; c < num_chunks; c++) {
+    for (const uint32_t i : chunk_changes[c].dead) {
+      pool.destroy(pool.getHandle(i));
+    }
+  }
+  for (size_t c = 0; c < num_chunks; c++) {
+    for (const uint32_t cell : chunk_changes[c].seed_cells) {
+      add(cell, SEED_BIOMASS);
+    }
+  }
+
+  // Seedlings were added with their biomass, recount all to stay exact.
+  std::fill(cell_biomass.begin(), cell_biomass.end(), 0.f);
+  std::fill(cell_grazing.begin(), cell_grazing.end(), 0.f);
+  const uint32_t num_slots = static_cast<uint32_t>(pool.getNumSlots());
+  for (uint32_t i = 0; i < num_slots; i++) {
+    if (pool.isAlive(i)) {
+      cell_biomass[cells[i]] += biomass[i];
+    }
+  }
+}
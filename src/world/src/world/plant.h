@@ -1,13 +1,154 @@
 #ifndef PLANT
 #define PLANT
 
-#include <warning_guards/warning_guards.h>
+#include <cstdint>
+#include <utils/handlePool.hpp>
+#include <utils/taskScheduler.hpp>
+#include <vector>
 
-THIRD_PARTY_HEADERS_BEGIN
-#include <settings.hpp>
-THIRD_PARTY_HEADERS_END
+#include "cellGrid.h"
 
+/*!
+ * \brief The state of one plant, see PlantPopulation::get().
+ */
+struct Plant {
+  uint32_t cell = 0;
+  // [kg]
+  float biomass = 0.f;
+  // [s]
+  float age = 0.f;
+};
 
-class Plant {};
+/*!
+ * \brief All plants of the world. Plants grow depending on the ground temperature, the
+ * biome and on how crowded their cell is, spread seeds into nearby cells, are grazed and die
+ * of age or starvation.
+ * The plants are stored as structure of arrays in slots of a HandlePool: a tick streams
+ * through a few dense arrays and dead plants leave their slot to the next seedling, thus
+ * a population of stable size does not allocate.
+ */
+class PlantPopulation {
+ public:
+  /*!
+   * \brief Removes all plants and sizes the per cell data.
+   * \param num_cells The number of cells of the CellGrid the plants grow on.
+   */
+  void resize(size_t num_cells);
+
+  /*!
+   * \brief Allocates memory for the given number of plants up front.
+   */
+  void reserve(size_t num_plants);
+
+  /*!
+   * \brief Adds a plant.
+   * \param cell The cell the plant grows in.
+   * \param biomass [kg] The initial biomass.
+   * \return The handle to refer to the plant.
+   */
+  utils::Handle add(uint32_t cell, float biomass);
+
+  /*!
+   * \brief Adds num_plants seedlings into random cells.
+   * \param seed Different seeds give different positions.
+   */
+  void sow(size_t num_plants, uint64_t seed);
+
+  /*!
+   * \return False if the plant was already dead.
+   */
+  bool remove(const utils::Handle& plant);
+
+  bool isAlive(const utils::Handle& plant) const { return pool.isAlive(plant); }
+
+  /*!
+   * \brief Returns a copy of the state of a living plant.
+   */
+  Plant get(const utils::Handle& plant) const {
+    return Plant{cells[plant.index], biomass[plant.index], age[plant.index]};
+  }
+
+  size_t size() const { return pool.size(); }
+
+  /*!
+   * \brief The biomass of all plants of the cell at the end of the last update().
+   * \return [kg]
+   */
+  float getCellBiomass(uint32_t cell) const { return cell_biomass[cell]; }
+
+  /*!
+   * \brief Eats from the plants of the cell. The plants lose the eaten biomass (in
+   * proportion to their own biomass) during the next update(). Not thread safe.
+   * \param cell The cell to eat in.
+   * \param amount [kg] How much should be eaten.
+   * \return [kg] How much could be eaten, limited by what is left in the cell.
+   */
+  float graze(uint32_t cell, float amount);
+
+  /*!
+   * \brief Simulates all plants for one time step.
+   * \param dt [s] The time step.
+   * \param grid Provides the ground temperature of the cells.
+   * \param scheduler Runs the growth of the plants in parallel.
+   * \param tick Seeds the random numbers of this step.
+   * \param biomes The biome of every cell (see biome.h) scales the growth by its fertility,
+   * nullptr for full fertility everywhere.
+   */
+  void update(double dt,
+              const CellGrid& grid,
+              utils::TaskScheduler& scheduler,
+              uint64_t tick,
+              const uint8_t* biomes = nullptr);
+
+ private:
+  // Births and deaths found by one chunk, applied after all chunks are done.
+  struct ChunkChanges {
+    std::vector<uint32_t> dead;
+    std::vector<uint32_t> seed_cells;
+  };
+
+  void updateChunk(
+      size_t chunk, double dt, const CellGrid& grid, uint64_t tick, const uint8_t* biomes);
+  /*!
+   * \brief Applies the changes of the chunks [0, num_chunks) of this update().
+   */
+  void applyChanges(size_t num_chunks);
+
+  utils::HandlePool pool;
+  // per slot
+  std::vector<uint32_t> cells;
+  std::vector<float> biomass;
+  std::vector<float> age;
+
+  // per cell
+  std::vector<float> cell_biomass;
+  std::vector<float> cell_grazing;
+
+  // reused every update()
+  std::vector<ChunkChanges> chunk_changes;
+
+  static constexpr size_t PLANTS_PER_CHUNK = 1 << 14;
+
+  // [1/s] relative growth of a plant under ideal conditions
+  static constexpr float GROWTH_RATE = 1e-4f;
+  // [kg] biomass of all plants of a cell at which growth stops
+  static constexpr float CELL_CAPACITY = 50.f;
+  // [K] temperature of the fastest growth and distance to it at which growth stops
+  static constexpr float OPTIMAL_TEMPERATURE_K = 293.15f;
+  static constexpr float TEMPERATURE_TOLERANCE_K = 25.f;
+  // [1/s] relative upkeep, without growth a plant starves
+  static constexpr float UPKEEP_RATE = 2e-5f;
+  // [kg] below a plant dies, above it spreads seeds
+  static constexpr float MIN_BIOMASS = 1e-3f;
+  static constexpr float SEEDING_BIOMASS = 0.5f;
+  // [kg] biomass of a seed (taken from the parent)
+  static constexpr float SEED_BIOMASS = 0.01f;
+  // [1/s] probability per second of a seeding plant to spread a seed
+  static constexpr float SEED_RATE = 1e-4f;
+  // seeds land up to this many cells away
+  static constexpr uint32_t SEED_DISTANCE = 2;
+  // [s]
+  static constexpr float MAX_AGE = 1e6f;
+};
 
 #endif
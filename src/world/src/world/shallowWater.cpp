@@ -0,0 +1,320 @@
+#include "shallowWater.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "gridGeometry.h"
+#include "gridStencil.h"
+
+namespace {
+
+using grid_stencil::getStencil;
+using grid_stencil::minimum;
+using grid_stencil::positive;
+using grid_stencil::Span;
+using grid_stencil::Stencil;
+
+// Avoids divisions by 0 for dry cells.
+constexpr double MIN_VOLUME = 1e-9;
+// [m] the velocity of thinner water is computed as if it was this deep
+constexpr double MIN_DEPTH = 1e-3;
+
+// 1 for a depth below the sea level >= 0, else 0, without a select (see grid_stencil)
+double isSea(double depth) { return 0.5 + std::copysign(0.5, depth); }
+
+// the arrays of all cells the passes work on
+struct Fields {
+  double* ground;
+  double* water;
+  // out of each cell towards left, right, down and up
+  double* flux_left;
+  double* flux_right;
+  double* flux_down;
+  double* flux_up;
+  double* transport;
+  double* speed;
+  double* sediment;
+  double* next_sediment;
+  double* next_ground;
+};
+
+// constants of one run derived from the parameters
+struct Constants {
+  double dt;
+  double area;
+  // flux change per difference of the water surfaces, the pipes have the cross section area
+  double acceleration;
+  double to_gradient;
+};
+
+/*!
+ * \brief Calls kernel(Span) for every cell of the rows * columns cells, blocks of rows in
+ * parallel.
+ */
+template <class Kernel>
+void forEachSpan(size_t rows,
+                 size_t columns,
+                 size_t cells_per_task,
+                 utils::TaskScheduler& scheduler,
+                 const Kernel& kernel) {
+  const size_t rows_per_task = std::max<size_t>(1, cells_per_task / columns);
+  const size_t num_tasks = (rows + rows_per_task - 1) / rows_per_task;
+  scheduler.parallelFor(num_tasks, [&](size_t task) {
+    const size_t end = std::min(rows, (task + 1) * rows_per_task);
+    for (size_t row = task * rows_per_task; row < end; row++) {
+      const size_t first = row * columns;
+      const bool has_down = row > 0;
+      const bool has_up = row + 1 < rows;
+      const size_t down = has_down ? first - columns : first;
+      const size_t up = has_up ? first + columns : first;
+      grid_stencil::forEachRowSpan(first, columns, down, up, has_down, has_up, kernel);
+    }
+  });
+}
+
+// The fluxes out of the cells of a span and into them.
+struct Flows {
+  const double* __restrict out_left;
+  const double* __restrict out_right;
+  const double* __restrict out_down;
+  const double* __restrict out_up;
+  const double* __restrict in_left;
+  const double* __restrict in_right;
+  const double* __restrict in_down;
+  const double* __restrict in_up;
+};
+
+Flows getFlows(const Fields& f, const Span& s) {
+  Flows flows;
+  flows.out_left = f.flux_left + s.begin;
+  flows.out_right = f.flux_right + s.begin;
+  flows.out_down = f.flux_down + s.begin;
+  flows.out_up = f.flux_up + s.begin;
+  flows.in_left = f.flux_right + s.left;
+  flows.in_right = f.flux_left + s.right;
+  // At the poles the own flux towards the missing row is 0.
+  flows.in_down = s.has_down ? f.flux_up + s.down : flows.out_down;
+  flows.in_up = s.has_up ? f.flux_down + s.up : flows.out_up;
+  return flows;
+}
+
+// The kernels get their arrays as restrict parameters, restrict locals do not spare GCC the
+// alias checks and it gives up vectorizing.
+
+// 1. The outflow of every cell, limited to the water it has.
+void updateFlux(size_t n,
+                Stencil g,
+                Stencil w,
+                double* __restrict f_left,
+                double* __restrict f_right,
+                double* __restrict f_down,
+                double* __restrict f_up,
+                double* __restrict transport,
+                const Constants& c) {
+  for (size_t j = 0; j < n; j++) {
+    const double surface = g.center[j] + w.center[j];
+    const double l = positive(f_left[j] + c.acceleration * (surface - g.left[j] - w.left[j]));
+    const double r = positive(f_right[j] + c.acceleration * (surface - g.right[j] - w.right[j]));
+    const double d = positive(f_down[j] + c.acceleration * (surface - g.down[j] - w.down[j]));
+    const double u = positive(f_up[j] + c.acceleration * (surface - g.up[j] - w.up[j]));
+    const double volume = c.area * w.center[j];
+    const double scale = minimum(1., volume / ((l + r + d + u) * c.dt + MIN_VOLUME));
+    f_left[j] = l * scale;
+    f_right[j] = r * scale;
+    f_down[j] = d * scale;
+    f_up[j] = u * scale;
+    transport[j] = c.dt / (volume + MIN_VOLUME);
+  }
+}
+
+// 2. The new water depth from in- and outflow, the speed of the water, rain and sea.
+void updateWater(size_t n,
+                 const double* __restrict g,
+                 double* __restrict w,
+                 double* __restrict speed,
+                 Flows flows,
+                 const Constants& c,
+                 const erosion::ShallowWaterParameters& p) {
+  const double rain = p.rain * c.dt;
+  const double remaining = 1. - p.evaporation * c.dt;
+  const double to_speed = 0.5 / p.cell_length;
+  for (size_t j = 0; j < n; j++) {
+    const double in =
+        flows.in_left[j] + flows.in_right[j] + flows.in_down[j] + flows.in_up[j];
+    const double out =
+        flows.out_left[j] + flows.out_right[j] + flows.out_down[j] + flows.out_up[j];
+    const double depth = w[j] + c.dt * (in - out) / c.area;
+    const double mean_depth = 0.5 * (w[j] + depth) + MIN_DEPTH;
+    const double flow_u =
+        flows.in_left[j] - flows.out_left[j] + flows.out_right[j] - flows.in_right[j];
+    const double flow_v = flows.in_down[j] - flows.out_down[j] + flows.out_up[j] - flows.in_up[j];
+    speed[j] = to_speed * std::sqrt(flow_u * flow_u + flow_v * flow_v) / mean_depth;
+    const double rained = (depth + rain) * remaining;
+    const double sea = p.sea_level - g[j];
+    w[j] = rained + isSea(sea) * (sea - rained);
+  }
+}
+
+// 3. Erosion and deposition, the ground goes to next_ground since the neighbours read it.
+template <bool HAS_STRENGTH>
+void erodeAndDeposit(size_t n,
+                     Stencil g,
+                     const double* __restrict w,
+                     const double* __restrict speed,
+                     const float* __restrict strength,
+                     double* __restrict sediment,
+                     double* __restrict next_ground,
+                     const Constants& c,
+                     const erosion::ShallowWaterParameters& p) {
+  const double to_depth_factor = 1. / p.full_capacity_depth;
+  for (size_t j = 0; j < n; j++) {
+    const double gradient_u = (g.right[j] - g.left[j]) * c.to_gradient;
+    const double gradient_v = (g.up[j] - g.down[j]) * c.to_gradient;
+    const double slope = gradient_u * gradient_u + gradient_v * gradient_v;
+    const double tilt = std::sqrt(slope / (1. + slope));
+    const double depth_factor = minimum(1., w[j] * to_depth_factor);
+    const double land = 1. - isSea(p.sea_level - g.center[j]);
+    const double capacity =
+        p.capacity * (tilt + positive(p.min_tilt - tilt)) * speed[j] * depth_factor * land;
+    const double free = capacity - sediment[j];
+    const double eroded = positive(free) * (HAS_STRENGTH ? static_cast<double>(strength[j]) : 1.);
+    const double amount = p.erosion * eroded + p.deposition * (free - positive(free));
+    next_ground[j] = g.center[j] - amount;
+    sediment[j] += amount;
+  }
+}
+
+// 4. The sediment moves with the water, in the same fractions. The ground is updated.
+void moveSediment(size_t n,
+                  Stencil sediment,
+                  Stencil transport,
+                  Flows flows,
+                  double* __restrict next_sediment,
+                  const double* __restrict next_ground,
+                  double* __restrict g) {
+  for (size_t j = 0; j < n; j++) {
+    const double out =
+        (flows.out_left[j] + flows.out_right[j] + flows.out_down[j] + flows.out_up[j]) *
+        transport.center[j];
+    const double in = sediment.left[j] * flows.in_left[j] * transport.left[j] +
+                      sediment.right[j] * flows.in_right[j] * transport.right[j] +
+                      sediment.down[j] * flows.in_down[j] * transport.down[j] +
+                      sediment.up[j] * flows.in_up[j] * transport.up[j];
+    next_sediment[j] = sediment.center[j] * (1. - out) + in;
+    g[j] = next_ground[j];
+  }
+}
+}  // namespace
+
+namespace erosion {
+
+void ShallowWater::resize(size_t num_cells) {
+  for (int d = 0; d < NUM_DIRECTIONS; d++) {
+    flux[d].assign(num_cells, 0.);
+  }
+  transport.assign(num_cells, 0.);
+  speed.assign(num_cells, 0.);
+  sediment.assign(num_cells, 0.);
+  next_sediment.assign(num_cells, 0.);
+  next_ground.assign(num_cells, 0.);
+}
+
+Stats ShallowWater::run(CellGrid& grid,
+                        const float* strength,
+                        size_t num_steps,
+                        utils::TaskScheduler& scheduler) {
+  const auto start = std::chrono::steady_clock::now();
+  Stats stats;
+  const uint32_t num_grid_cells = static_cast<uint32_t>(grid.getNumCells());
+  const size_t rows = GridGeometry::getNumRows(num_grid_cells);
+  const size_t columns = GridGeometry::getNumColumns(num_grid_cells);
+  if (rows < 2) {
+    return stats;
+  }
+  const size_t num_cells = rows * columns;
+  resize(num_cells);
+
+  const ShallowWaterParameters& p = parameters;
+  Constants c;
+  c.dt = p.time_step;
+  c.area = p.cell_length * p.cell_length;
+  c.acceleration = c.dt * p.gravity * p.cell_length;
+  c.to_gradient = 0.5 / p.cell_length;
+
+  Fields f;
+  f.ground = grid.getField(GROUND, HEIGHT);
+  f.water = grid.getField(WATER, HEIGHT);
+  f.flux_left = flux[LEFT].data();
+  f.flux_right = flux[RIGHT].data();
+  f.flux_down = flux[DOWN].data();
+  f.flux_up = flux[UP].data();
+  f.transport = transport.data();
+  f.speed = speed.data();
+  f.next_ground = next_ground.data();
+
+  // Every pass only writes the cells of its span, the passes are separated by parallelFor.
+  for (size_t step = 0; step < num_steps; step++) {
+    f.sediment = sediment.data();
+    f.next_sediment = next_sediment.data();
+    forEachSpan(rows, columns, CELLS_PER_TASK, scheduler, [&](const Span& s) {
+      updateFlux(s.n,
+                 getStencil(f.ground, s),
+                 getStencil(f.water, s),
+                 f.flux_left + s.begin,
+                 f.flux_right + s.begin,
+                 f.flux_down + s.begin,
+                 f.flux_up + s.begin,
+                 f.transport + s.begin,
+                 c);
+    });
+    forEachSpan(rows, columns, CELLS_PER_TASK, scheduler, [&](const Span& s) {
+      updateWater(
+          s.n, f.ground + s.begin, f.water + s.begin, f.speed + s.begin, getFlows(f, s), c, p);
+    });
+    forEachSpan(rows, columns, CELLS_PER_TASK, scheduler, [&](const Span& s) {
+      if (strength == nullptr) {
+        erodeAndDeposit<false>(s.n,
+                               getStencil(f.ground, s),
+                               f.water + s.begin,
+                               f.speed + s.begin,
+                               nullptr,
+                               f.sediment + s.begin,
+                               f.next_ground + s.begin,
+                               c,
+                               p);
+      } else {
+        erodeAndDeposit<true>(s.n,
+                              getStencil(f.ground, s),
+                              f.water + s.begin,
+                              f.speed + s.begin,
+                              strength + s.begin,
+                              f.sediment + s.begin,
+                              f.next_ground + s.begin,
+                              c,
+                              p);
+      }
+    });
+    forEachSpan(rows, columns, CELLS_PER_TASK, scheduler, [&](const Span& s) {
+      moveSediment(s.n,
+                   getStencil(f.sediment, s),
+                   getStencil(f.transport, s),
+                   getFlows(f, s),
+                   f.next_sediment + s.begin,
+                   f.next_ground + s.begin,
+                   f.ground + s.begin);
+    });
+    sediment.swap(next_sediment);
+  }
+
+  // What is still in the water settles.
+  for (size_t i = 0; i < num_cells; i++) {
+    f.ground[i] += sediment[i];
+  }
+
+  stats.num_steps = num_steps;
+  stats.num_cell_updates = num_steps * num_cells;
+  stats.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+}  // namespace erosion
@@ -0,0 +1,96 @@
+#ifndef SHALLOW_WATER
+#define SHALLOW_WATER
+
+#include <cstddef>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+#include "cellGrid.h"
+#include "erosion.h"
+
+namespace erosion {
+
+struct ShallowWaterParameters {
+  // [m] cells below are sea
+  double sea_level = 0.;
+  // [m] the edge of a cell
+  double cell_length = 1000.;
+  // [s] per step
+  double time_step = 2.;
+  double gravity = 9.81;
+  // [m/s]
+  double rain = 1e-3;
+  // [1/s] fraction of the water evaporating
+  double evaporation = 5e-4;
+  // sediment [m] the water can carry per tilt (sin) and speed [m/s]
+  double capacity = 0.1;
+  // lower bound of the tilt used for the capacity, flat land still erodes a little
+  double min_tilt = 0.01;
+  // [m] water deeper than this carries the full capacity, shallower water less
+  double full_capacity_depth = 1.;
+  // fraction of the free capacity eroded and of the excess sediment dropped per step
+  double erosion = 0.05;
+  double deposition = 0.05;
+};
+
+/*!
+ * \brief Hydraulic erosion on the grid instead of by droplets (pipe model, Mei et al. 2007):
+ * rain fills the WATER layer, water flows through virtual pipes to the 4 neighbouring cells
+ * driven by the difference of the water surfaces, dissolves ground where it flows fast and
+ * drops it where it slows down. Sinks fill up to lakes, rivers carve their beds until they
+ * reach the sea. Cells below the sea level are held at the sea level and never erode.
+ * Every step is a few stencil passes over the rows of the grid (laid out as in GridGeometry),
+ * each cell only writes itself. Thus a step is fully data parallel, vectorizes along the
+ * rows and gives the same result on any number of threads. The cells are treated as squares
+ * of equal size, the distortion towards the poles is ignored. Sediment moves with the water
+ * between the cells, ground + sediment is conserved.
+ */
+class ShallowWater {
+ public:
+  ShallowWater() = default;
+
+  explicit ShallowWater(const ShallowWaterParameters& parameters) : parameters(parameters) {}
+
+  /*!
+   * \brief Runs num_steps steps on the ground and water heights of the grid.
+   * The WATER HEIGHT is the depth of the water on the ground, it keeps the lakes and rivers.
+   * Sediment still in the water at the end settles in its cell.
+   * \param grid Its GROUND and WATER heights are changed.
+   * \param strength Per cell factor of the erosion (e.g. by area type), nullptr for 1 everywhere.
+   * \param num_steps The number of steps, each updates every cell once.
+   * \param scheduler Runs blocks of rows in parallel.
+   * \return num_steps and num_cell_updates, no droplets.
+   */
+  Stats run(CellGrid& grid,
+            const float* strength,
+            size_t num_steps,
+            utils::TaskScheduler& scheduler);
+
+  const ShallowWaterParameters& getParameters() const { return parameters; }
+
+  void setParameters(const ShallowWaterParameters& parameters) { this->parameters = parameters; }
+
+ private:
+  // the neighbours of a cell in the flux arrays
+  enum Direction { LEFT, RIGHT, DOWN, UP, NUM_DIRECTIONS };
+
+  void resize(size_t num_cells);
+
+  ShallowWaterParameters parameters;
+
+  // [m^3/s] out of each cell per direction
+  std::vector<double> flux[NUM_DIRECTIONS];
+  // [s/m^3] time step per water volume, the fraction of the water a flux moves per step
+  std::vector<double> transport;
+  // [m/s]
+  std::vector<double> speed;
+  // [m] ground height dissolved in the water
+  std::vector<double> sediment;
+  std::vector<double> next_sediment;
+  std::vector<double> next_ground;
+
+  static constexpr size_t CELLS_PER_TASK = 8192;
+};
+}  // namespace erosion
+
+#endif
@@ -0,0 +1,236 @@
+#include "spatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Inserts two zero bits between each of the lower 10 bits.
+uint32_t spreadBits(uint32_t v) {
+  v &= 0x3ffu;
+  v = (v | (v << 16)) & 0x030000ffu;
+  v = (v | (v << 8)) & 0x0300f00fu;
+  v = (v | (v << 4)) & 0x030c30c3u;
+  v = (v | (v << 2)) & 0x09249249u;
+  return v;
+}
+
+uint32_t getSlot(uint32_t key, size_t table_size) {
+  // Fibonacci hashing, table_size is a power of two.
+  return static_cast<uint32_t>((key * 2654435769u) & (table_size - 1));
+}
+
+bool isCloser(const SpatialIndex::Neighbor& a, const SpatialIndex::Neighbor& b) {
+  return a.distance_squared < b.distance_squared;
+}
+}  // namespace
+
+void SpatialIndex::setCellSize(size_t num_points) {
+  // A cell of size h covers about h^2 of the 4 pi of the sphere.
+  constexpr float AREA = 4.f * 3.14159265f;
+  const float sparse_size =
+      std::sqrt(AREA * POINTS_PER_CELL / static_cast<float>(std::max<size_t>(num_points, 1)));
+  const float chord = std::max(std::sqrt(toDistanceSquared(min_cell_size)), sparse_size);
+  num_cells_per_axis = static_cast<uint32_t>(
+      std::min<float>(MAX_CELLS_PER_AXIS, std::max(1.f, std::ceil(2.f / chord))));
+  this->cell_size = 2.f / static_cast<float>(num_cells_per_axis);
+}
+
+float SpatialIndex::toDistanceSquared(float angle) {
+  const float half_chord = std::sin(0.5f * std::min(angle, 3.14159265f));
+  return 4.f * half_chord * half_chord;
+}
+
+uint32_t SpatialIndex::getCellCoordinate(float coordinate) const {
+  const float cell = std::max(0.f, (coordinate + 1.f) / cell_size);
+  return std::min(num_cells_per_axis - 1, static_cast<uint32_t>(cell));
+}
+
+uint32_t SpatialIndex::getKey(uint32_t cx, uint32_t cy, uint32_t cz) {
+  return spreadBits(cx) | (spreadBits(cy) << 1) | (spreadBits(cz) << 2);
+}
+
+void SpatialIndex::radixSort() {
+  // LSD radix sort of the 30 bit keys in 3 passes of 10 bits, stable.
+  constexpr uint32_t BITS = 10;
+  constexpr uint32_t BUCKETS = 1 << BITS;
+  const size_t n = keys.size();
+  order.resize(n);
+  sort_keys.resize(n);
+  sort_ids.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    order[i] = static_cast<uint32_t>(i);
+  }
+  uint32_t counts[BUCKETS];
+  for (uint32_t shift = 0; shift < 3 * BITS; shift += BITS) {
+    std::fill(counts, counts + BUCKETS, 0);
+    for (size_t i = 0; i < n; i++) {
+      counts[(keys[order[i]] >> shift) & (BUCKETS - 1)]++;
+    }
+    uint32_t sum = 0;
+    for (auto& count : counts) {
+      const uint32_t c = count;
+      count = sum;
+      sum += c;
+    }
+    for (size_t i = 0; i < n; i++) {
+      sort_ids[counts[(keys[order[i]] >> shift) & (BUCKETS - 1)]++] = order[i];
+    }
+    order.swap(sort_ids);
+  }
+
+  // Applies the permutation to all arrays.
+  for (size_t i = 0; i < n; i++) {
+    sort_keys[i] = keys[order[i]];
+    sort_ids[i] = ids[order[i]];
+  }
+  keys.swap(sort_keys);
+  ids.swap(sort_ids);
+  for (std::vector<float>* coordinate : {&x, &y, &z}) {
+    std::vector<float>& values = *coordinate;
+    sort_coordinates.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      sort_coordinates[i] = values[order[i]];
+    }
+    values.swap(sort_coordinates);
+  }
+}
+
+void SpatialIndex::buildCells() {
+  size_t num_occupied = 0;
+  for (size_t i = 0; i < keys.size(); i++) {
+    num_occupied += (i == 0 || keys[i] != keys[i - 1]) ? 1 : 0;
+  }
+  size_t table_size = 16;
+  while (table_size < 2 * num_occupied) {
+    table_size *= 2;
+  }
+  cells.assign(table_size, CellRange{NO_CELL, 0, 0});
+
+  for (size_t begin = 0; begin < keys.size();) {
+    size_t end = begin + 1;
+    while (end < keys.size() && keys[end] == keys[begin]) {
+      end++;
+    }
+    uint32_t slot = getSlot(keys[begin], table_size);
+    while (cells[slot].key != NO_CELL) {
+      slot = (slot + 1) & (table_size - 1);
+    }
+    cells[slot] = {keys[begin], static_cast<uint32_t>(begin), static_cast<uint32_t>(end)};
+    begin = end;
+  }
+}
+
+const SpatialIndex::CellRange* SpatialIndex::findCell(uint32_t key) const {
+  for (uint32_t slot = getSlot(key, cells.size());; slot = (slot + 1) & (cells.size() - 1)) {
+    if (cells[slot].key == key) {
+      return &cells[slot];
+    }
+    if (cells[slot].key == NO_CELL) {
+      return nullptr;
+    }
+  }
+}
+
+void SpatialIndex::findInRadius(const Eigen::Vector3f& position,
+                                float radius,
+                                std::vector<Neighbor>& result) const {
+  if (keys.empty()) {
+    return;
+  }
+  const float max_distance_squared = toDistanceSquared(radius);
+  const float chord = std::sqrt(max_distance_squared);
+  uint32_t min[3];
+  uint32_t max[3];
+  for (int a = 0; a < 3; a++) {
+    min[a] = getCellCoordinate(position[a] - chord);
+    max[a] = getCellCoordinate(position[a] + chord);
+  }
+  forEachCell(min, max, [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+      const float dx = x[i] - position.x();
+      const float dy = y[i] - position.y();
+      const float dz = z[i] - position.z();
+      const float distance_squared = dx * dx + dy * dy + dz * dz;
+      if (distance_squared <= max_distance_squared) {
+        result.push_back({ids[i], distance_squared});
+      }
+    }
+  });
+}
+
+void SpatialIndex::findNearest(const Eigen::Vector3f& position,
+                               size_t k,
+                               std::vector<Neighbor>& result) const {
+  result.clear();
+  if (k == 0 || keys.empty()) {
+    return;
+  }
+  // result is a max heap of the k closest points found so far.
+  const auto visit = [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+      const float dx = x[i] - position.x();
+      const float dy = y[i] - position.y();
+      const float dz = z[i] - position.z();
+      const Neighbor neighbor{ids[i], dx * dx + dy * dy + dz * dz};
+      if (result.size() < k) {
+        result.push_back(neighbor);
+        std::push_heap(result.begin(), result.end(), isCloser);
+      } else if (isCloser(neighbor, result.front())) {
+        std::pop_heap(result.begin(), result.end(), isCloser);
+        result.back() = neighbor;
+        std::push_heap(result.begin(), result.end(), isCloser);
+      }
+    }
+  };
+
+  const int64_t center[3] = {getCellCoordinate(position.x()),
+                             getCellCoordinate(position.y()),
+                             getCellCoordinate(position.z())};
+  const int64_t last = num_cells_per_axis - 1;
+  for (int64_t ring = 0;; ring++) {
+    // With few points spread far a ring has more cells than there are points: scanning all
+    // points is cheaper.
+    const int64_t ring_cells = (2 * ring + 1) * (2 * ring + 1) * (2 * ring + 1);
+    if (ring > 1 && ring_cells - (2 * ring - 1) * (2 * ring - 1) * (2 * ring - 1) >
+                        static_cast<int64_t>(ids.size())) {
+      result.clear();
+      visit(0, static_cast<uint32_t>(ids.size()));
+      break;
+    }
+    // Visits the cells of the shell of the box of the ring.
+    bool covers_grid = true;
+    int64_t min[3];
+    int64_t max[3];
+    for (int a = 0; a < 3; a++) {
+      min[a] = std::max<int64_t>(0, center[a] - ring);
+      max[a] = std::min(last, center[a] + ring);
+      covers_grid &= min[a] == 0 && max[a] == last;
+    }
+    for (int64_t cz = min[2]; cz <= max[2]; cz++) {
+      const bool z_inside = std::abs(cz - center[2]) < ring;
+      for (int64_t cy = min[1]; cy <= max[1]; cy++) {
+        const bool yz_inside = z_inside && std::abs(cy - center[1]) < ring;
+        for (int64_t cx = min[0]; cx <= max[0]; cx++) {
+          if (yz_inside && std::abs(cx - center[0]) < ring) {
+            // visited by an inner ring, jump to the far side of the shell
+            cx = center[0] + ring - 1;
+            continue;
+          }
+          const CellRange* cell = findCell(getKey(static_cast<uint32_t>(cx),
+                                                  static_cast<uint32_t>(cy),
+                                                  static_cast<uint32_t>(cz)));
+          if (cell != nullptr) {
+            visit(cell->begin, cell->end);
+          }
+        }
+      }
+    }
+    // Points of the next ring are at least ring cells away along one axis.
+    const float ring_distance = static_cast<float>(ring) * cell_size;
+    if (covers_grid || result.size() == ids.size() ||
+        (result.size() == k && result.front().distance_squared <= ring_distance * ring_distance)) {
+      break;
+    }
+  }
+  std::sort_heap(result.begin(), result.end(), isCloser);
+}
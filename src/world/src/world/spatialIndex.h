@@ -0,0 +1,147 @@
+#ifndef SPATIAL_INDEX
+#define SPATIAL_INDEX
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief A uniform grid index for "what is near me" queries between points on the unit sphere.
+ * The grid covers the cube around the sphere, only the cells along the surface are occupied.
+ * The points are stored sorted by the Morton code of their cell, thus the points of one cell
+ * are one consecutive range (the cell list) and neighbouring cells are mostly close in memory.
+ * A hash table maps the occupied cells to their range. A query only visits the cells around
+ * it: O(k) for k found points instead of O(N).
+ * Queries are const and may run concurrently from many threads, build() must not run
+ * concurrently to anything else.
+ */
+class SpatialIndex {
+ public:
+  // A found point.
+  struct Neighbor {
+    // the index the point had in build()
+    uint32_t id;
+    // squared chord length through the sphere
+    float distance_squared;
+  };
+
+  /*!
+   * \param min_cell_size [rad] Should be about the radius of the typical query. Cells are
+   * made larger if there are too few points for it, see build().
+   */
+  explicit SpatialIndex(float min_cell_size = 1e-2f) : min_cell_size(min_cell_size) {}
+
+  /*!
+   * \brief Indexes n points, the former points are removed. The cells are sized for the
+   * points to be not much sparser than POINTS_PER_CELL, else the rings of findNearest() get
+   * too many empty cells.
+   * \param get_position Returns the position of the i-th point, which is its id.
+   */
+  template <class GetPosition>
+  void build(size_t n, GetPosition get_position) {
+    setCellSize(n);
+    ids.resize(n);
+    keys.resize(n);
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      const Eigen::Vector3f p = get_position(static_cast<uint32_t>(i));
+      ids[i] = static_cast<uint32_t>(i);
+      x[i] = p.x();
+      y[i] = p.y();
+      z[i] = p.z();
+      keys[i] = getKey(
+          getCellCoordinate(p.x()), getCellCoordinate(p.y()), getCellCoordinate(p.z()));
+    }
+    radixSort();
+    buildCells();
+  }
+
+  size_t size() const { return ids.size(); }
+
+  /*!
+   * \brief Finds all points within radius around position, in no particular order.
+   * \param radius [rad] Should not be much larger than the cell size, all cells of the
+   * bounding box are visited.
+   * \param result The found points are appended.
+   */
+  void findInRadius(const Eigen::Vector3f& position,
+                    float radius,
+                    std::vector<Neighbor>& result) const;
+
+  /*!
+   * \brief Finds the k closest points to position. Visits rings of cells around position
+   * until the k-th closest point is closer than the next ring.
+   * \param result Is overwritten with the min(k, size()) closest points, closest first.
+   */
+  void findNearest(const Eigen::Vector3f& position, size_t k, std::vector<Neighbor>& result) const;
+
+  /*!
+   * \brief The squared chord length of an angle on the unit sphere, see Neighbor.
+   */
+  static float toDistanceSquared(float angle);
+
+ private:
+  // The points [begin, end) of the sorted arrays are in the cell with the morton code key.
+  struct CellRange {
+    uint32_t key;
+    uint32_t begin;
+    uint32_t end;
+  };
+
+  void setCellSize(size_t num_points);
+  uint32_t getCellCoordinate(float coordinate) const;
+  static uint32_t getKey(uint32_t cx, uint32_t cy, uint32_t cz);
+
+  // Sorts all arrays by key.
+  void radixSort();
+  void buildCells();
+
+  const CellRange* findCell(uint32_t key) const;
+
+  // Calls visit(begin, end) for the range of every occupied cell of the box.
+  template <class Visit>
+  void forEachCell(const uint32_t min[3], const uint32_t max[3], Visit visit) const {
+    for (uint32_t cz = min[2]; cz <= max[2]; cz++) {
+      for (uint32_t cy = min[1]; cy <= max[1]; cy++) {
+        for (uint32_t cx = min[0]; cx <= max[0]; cx++) {
+          const CellRange* cell = findCell(getKey(cx, cy, cz));
+          if (cell != nullptr) {
+            visit(cell->begin, cell->end);
+          }
+        }
+      }
+    }
+  }
+
+  // [rad]
+  float min_cell_size;
+  // [1] chord length of a cell, cells per axis
+  float cell_size = 2.f;
+  uint32_t num_cells_per_axis = 1;
+
+  // per point, sorted by key
+  std::vector<uint32_t> keys;
+  std::vector<uint32_t> ids;
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+
+  // open addressing hash table of the occupied cells, a power of two in size
+  std::vector<CellRange> cells;
+
+  // reused by radixSort()
+  std::vector<uint32_t> sort_keys;
+  std::vector<uint32_t> sort_ids;
+  std::vector<uint32_t> order;
+  std::vector<float> sort_coordinates;
+
+  static constexpr uint32_t NO_CELL = ~0u;
+  // 10 bits per axis make a 30 bit Morton code
+  static constexpr uint32_t MAX_CELLS_PER_AXIS = 1 << 10;
+  static constexpr float POINTS_PER_CELL = 2.f;
+};
+
+#endif
@@ -0,0 +1,357 @@
+#include "weather.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "gridGeometry.h"
+#include "gridStencil.h"
+
+namespace {
+
+using grid_stencil::getStencil;
+using grid_stencil::Span;
+using grid_stencil::Stencil;
+
+// constants of one step derived from the parameters
+struct StepConstants {
+  double dt;
+  // 1 / (2 * cell length), for centered differences
+  double to_gradient;
+  double gas_constant;
+  // fraction of the wind lost per step
+  double friction;
+  // fraction of the difference to the equilibrium temperature removed per step
+  double relaxation;
+  double smoothing;
+};
+
+// a * dq/dx taken from the upwind side: the centered difference minus its correction, which
+// is a select free form of the two one sided differences.
+double upwind(double a, double q, double minus, double plus, double to_gradient) {
+  return to_gradient * (a * (plus - minus) - std::abs(a) * (plus - 2. * q + minus));
+}
+
+// the difference of the mean of the 4 neighbours to the cell
+double toNeighbourMean(const Stencil& s, size_t j) {
+  return 0.25 * (s.left[j] + s.right[j] + s.down[j] + s.up[j]) - s.center[j];
+}
+
+// The kernels get their arrays as restrict parameters, see shallowWater.cpp.
+
+// 1. The wind from the pressure gradient (p = density * R * T), Coriolis force and friction.
+void updateWindKernel(size_t n,
+                      Stencil temperature,
+                      Stencil density,
+                      Stencil east,
+                      Stencil north,
+                      double coriolis,
+                      const StepConstants& c,
+                      double* __restrict next_east,
+                      double* __restrict next_north) {
+  for (size_t j = 0; j < n; j++) {
+    const double p_left = density.left[j] * temperature.left[j];
+    const double p_right = density.right[j] * temperature.right[j];
+    const double p_down = density.down[j] * temperature.down[j];
+    const double p_up = density.up[j] * temperature.up[j];
+    const double to_acceleration = -c.gas_constant * c.to_gradient / density.center[j];
+    const double u = east.center[j];
+    const double v = north.center[j];
+    const double advection_u = upwind(u, u, east.left[j], east.right[j], c.to_gradient) +
+                               upwind(v, u, east.down[j], east.up[j], c.to_gradient);
+    const double advection_v = upwind(u, v, north.left[j], north.right[j], c.to_gradient) +
+                               upwind(v, v, north.down[j], north.up[j], c.to_gradient);
+    next_east[j] = u + c.dt * (to_acceleration * (p_right - p_left) + coriolis * v - advection_u) -
+                   c.friction * u + c.smoothing * toNeighbourMean(east, j);
+    next_north[j] = v + c.dt * (to_acceleration * (p_up - p_down) - coriolis * u - advection_v) -
+                    c.friction * v + c.smoothing * toNeighbourMean(north, j);
+  }
+}
+
+// 2. Temperature and density move with the new wind, the temperature approaches equilibrium.
+void updateAirKernel(size_t n,
+                     Stencil temperature,
+                     Stencil density,
+                     Stencil east,
+                     Stencil north,
+                     const double* __restrict equilibrium,
+                     const StepConstants& c,
+                     double* __restrict next_temperature,
+                     double* __restrict next_density) {
+  for (size_t j = 0; j < n; j++) {
+    const double u = east.center[j];
+    const double v = north.center[j];
+    const double t = temperature.center[j];
+    const double rho = density.center[j];
+    const double advection_t =
+        upwind(u, t, temperature.left[j], temperature.right[j], c.to_gradient) +
+        upwind(v, t, temperature.down[j], temperature.up[j], c.to_gradient);
+    const double advection_rho = upwind(u, rho, density.left[j], density.right[j], c.to_gradient) +
+                                 upwind(v, rho, density.down[j], density.up[j], c.to_gradient);
+    const double divergence =
+        c.to_gradient * (east.right[j] - east.left[j] + north.up[j] - north.down[j]);
+    next_temperature[j] = t - c.dt * advection_t + c.relaxation * (equilibrium[j] - t) +
+                          c.smoothing * toNeighbourMean(temperature, j);
+    next_density[j] = rho - c.dt * (advection_rho + rho * divergence) +
+                      c.smoothing * toNeighbourMean(density, j);
+  }
+}
+
+StepConstants getStepConstants(const WeatherParameters& p, double dt, double cell_length) {
+  StepConstants c;
+  c.dt = dt;
+  c.to_gradient = 0.5 / cell_length;
+  c.gas_constant = p.gas_constant;
+  c.friction = dt / p.friction_time;
+  c.relaxation = dt / p.relaxation_time;
+  c.smoothing = p.smoothing;
+  return c;
+}
+
+// z of the center of the row on the unit sphere, rows are of equal height in z
+double getRowZ(size_t row, size_t rows) {
+  return 2. * (static_cast<double>(row) + 0.5) / static_cast<double>(rows) - 1.;
+}
+}  // namespace
+
+void WeatherSolver::load(const CellGrid& grid) {
+  tiles.clear();
+  num_cells = grid.getNumCells();
+  const uint32_t num_grid_cells = static_cast<uint32_t>(num_cells);
+  rows = GridGeometry::getNumRows(num_grid_cells);
+  columns = GridGeometry::getNumColumns(num_grid_cells);
+  if (rows < 2) {
+    return;
+  }
+  const double pi = static_cast<double>(GridGeometry::PI);
+  const double surface = 4. * pi * parameters.planet_radius * parameters.planet_radius;
+  cell_length = std::sqrt(surface / static_cast<double>(rows * columns));
+  time_step = parameters.courant * cell_length / parameters.max_speed;
+
+  const GridField grid_fields[NUM_FIELDS] = {
+      TEMPERATURE, DENSITY, MASS_FLOW_GRADIENT_X, MASS_FLOW_GRADIENT_Y};
+  const double* ground = grid.getField(GROUND, HEIGHT);
+  const size_t rows_per_tile = std::max(MIN_ROWS_PER_TILE, CELLS_PER_TILE / columns);
+  for (size_t first_row = 0; first_row < rows; first_row += rows_per_tile) {
+    tiles.emplace_back();
+    Tile& tile = tiles.back();
+    tile.first_row = first_row;
+    tile.num_rows = std::min(rows_per_tile, rows - first_row);
+    const size_t first_cell = first_row * columns;
+    const size_t tile_cells = tile.num_rows * columns;
+    for (int f = 0; f < NUM_FIELDS; f++) {
+      tile.values[f].assign(tile_cells + 2 * columns, 0.);
+      tile.next[f].assign(tile_cells + 2 * columns, 0.);
+      const double* source = grid.getField(AIR, grid_fields[f]) + first_cell;
+      std::copy(source, source + tile_cells, tile.values[f].begin() + columns);
+    }
+
+    tile.equilibrium.resize(tile_cells);
+    tile.coriolis.resize(tile.num_rows);
+    for (size_t r = 0; r < tile.num_rows; r++) {
+      const double z = getRowZ(first_row + r, rows);
+      tile.coriolis[r] = 2. * parameters.rotation * z;
+      for (size_t c = 0; c < columns; c++) {
+        tile.equilibrium[r * columns + c] =
+            getEquilibriumTemperature(z, ground[first_cell + r * columns + c]);
+      }
+    }
+  }
+
+  for (size_t t = 0; t < tiles.size(); t++) {
+    for (int f = 0; f < NUM_FIELDS; f++) {
+      pullHalo(t, static_cast<Field>(f));
+    }
+  }
+}
+
+void WeatherSolver::setEquilibriumTemperature(CellGrid& grid) const {
+  const size_t num_grid_cells = grid.getNumCells();
+  const uint32_t cells = static_cast<uint32_t>(num_grid_cells);
+  const size_t grid_rows = GridGeometry::getNumRows(cells);
+  const size_t grid_columns = GridGeometry::getNumColumns(cells);
+  const double* ground = grid.getField(GROUND, HEIGHT);
+  double* temperature = grid.getField(AIR, TEMPERATURE);
+  for (size_t i = 0; i < num_grid_cells; i++) {
+    const size_t row = std::min(grid_rows - 1, i / grid_columns);
+    temperature[i] = getEquilibriumTemperature(getRowZ(row, grid_rows), ground[i]);
+  }
+}
+
+double WeatherSolver::getEquilibriumTemperature(double z, double height) const {
+  const double temperature_range = parameters.equator_temperature - parameters.pole_temperature;
+  const double sea_level_temperature =
+      parameters.pole_temperature + temperature_range * (1. - z * z);
+  return sea_level_temperature - parameters.lapse_rate * std::max(0., height);
+}
+
+void WeatherSolver::store(CellGrid& grid) {
+  if (tiles.empty() || grid.getNumCells() != num_cells) {
+    return;
+  }
+  for (size_t t = 0; t < tiles.size(); t++) {
+    for (int f = 0; f < NUM_FIELDS; f++) {
+      pullHalo(t, static_cast<Field>(f));
+    }
+  }
+
+  const double to_gradient = 0.5 / cell_length;
+  LayerFields air = grid.getLayer(AIR);
+  for (const Tile& tile : tiles) {
+    const size_t first_cell = tile.first_row * columns;
+    const size_t tile_cells = tile.num_rows * columns;
+    // with the halo rows, the interior starts at columns
+    const double* temperature = tile.values[AIR_TEMPERATURE].data();
+    const double* density = tile.values[AIR_DENSITY].data();
+    const double* east = tile.values[WIND_EAST].data();
+    const double* north = tile.values[WIND_NORTH].data();
+    const size_t end = columns + tile_cells;
+    std::copy(temperature + columns, temperature + end, air.temperature + first_cell);
+    std::copy(density + columns, density + end, air.density + first_cell);
+    std::copy(east + columns, east + end, air.mass_flow_gradient[0] + first_cell);
+    std::copy(north + columns, north + end, air.mass_flow_gradient[1] + first_cell);
+    std::fill(air.mass_flow_gradient[2] + first_cell,
+              air.mass_flow_gradient[2] + first_cell + tile_cells,
+              0.);
+
+    for (size_t i = 0; i < tile_cells; i++) {
+      const size_t column = i % columns;
+      const size_t center = columns + i;
+      const size_t left = (column == 0) ? center + columns - 1 : center - 1;
+      const size_t right = (column + 1 == columns) ? center + 1 - columns : center + 1;
+      const size_t down = center - columns;
+      const size_t up = center + columns;
+      const size_t cell = first_cell + i;
+      air.temperature_gradient[0][cell] = (temperature[right] - temperature[left]) * to_gradient;
+      air.temperature_gradient[1][cell] = (temperature[up] - temperature[down]) * to_gradient;
+      air.temperature_gradient[2][cell] = 0.;
+      air.density_gradient[0][cell] = (density[right] - density[left]) * to_gradient;
+      air.density_gradient[1][cell] = (density[up] - density[down]) * to_gradient;
+      air.density_gradient[2][cell] = 0.;
+    }
+  }
+}
+
+WeatherStats WeatherSolver::simulate(double duration, utils::TaskScheduler& scheduler) {
+  const auto start = std::chrono::steady_clock::now();
+  WeatherStats stats;
+  if (tiles.empty() || duration <= 0.) {
+    return stats;
+  }
+
+  const size_t num_steps = static_cast<size_t>(std::ceil(duration / time_step));
+  for (size_t step = 0; step < num_steps; step++) {
+    // The previous pass changed temperature and density, the wind halos are up to date.
+    scheduler.parallelFor(tiles.size(), [this](size_t t) {
+      pullHalo(t, AIR_TEMPERATURE);
+      pullHalo(t, AIR_DENSITY);
+      updateWind(tiles[t]);
+    });
+    // Only after all tiles are done, the neighbours read the old wind.
+    for (Tile& tile : tiles) {
+      tile.values[WIND_EAST].swap(tile.next[WIND_EAST]);
+      tile.values[WIND_NORTH].swap(tile.next[WIND_NORTH]);
+    }
+
+    scheduler.parallelFor(tiles.size(), [this](size_t t) {
+      pullHalo(t, WIND_EAST);
+      pullHalo(t, WIND_NORTH);
+      updateAir(tiles[t]);
+    });
+    for (Tile& tile : tiles) {
+      tile.values[AIR_TEMPERATURE].swap(tile.next[AIR_TEMPERATURE]);
+      tile.values[AIR_DENSITY].swap(tile.next[AIR_DENSITY]);
+    }
+  }
+
+  stats.num_steps = num_steps;
+  stats.num_cell_updates = num_steps * rows * columns;
+  stats.simulated_time = static_cast<double>(num_steps) * time_step;
+  stats.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+void WeatherSolver::pullHalo(size_t t, Field field) {
+  Tile& tile = tiles[t];
+  double* values = tile.values[field].data();
+  double* below = values;
+  double* above = values + (tile.num_rows + 1) * columns;
+  const double* first_row = values + columns;
+  const double* last_row = values + tile.num_rows * columns;
+
+  if (t > 0) {
+    const Tile& other = tiles[t - 1];
+    const double* source = other.values[field].data() + other.num_rows * columns;
+    std::copy(source, source + columns, below);
+  } else {
+    std::copy(first_row, first_row + columns, below);
+  }
+  if (t + 1 < tiles.size()) {
+    const double* source = tiles[t + 1].values[field].data() + columns;
+    std::copy(source, source + columns, above);
+  } else {
+    std::copy(last_row, last_row + columns, above);
+  }
+
+  if (field == WIND_NORTH) {
+    if (t == 0) {
+      std::transform(below, below + columns, below, [](double v) { return -v; });
+    }
+    if (t + 1 == tiles.size()) {
+      std::transform(above, above + columns, above, [](double v) { return -v; });
+    }
+  }
+}
+
+void WeatherSolver::updateWind(Tile& tile) const {
+  const StepConstants c = getStepConstants(parameters, time_step, cell_length);
+  const double* temperature = tile.values[AIR_TEMPERATURE].data();
+  const double* density = tile.values[AIR_DENSITY].data();
+  const double* east = tile.values[WIND_EAST].data();
+  const double* north = tile.values[WIND_NORTH].data();
+  double* next_east = tile.next[WIND_EAST].data();
+  double* next_north = tile.next[WIND_NORTH].data();
+  for (size_t r = 0; r < tile.num_rows; r++) {
+    const double coriolis = tile.coriolis[r];
+    const size_t first = (r + 1) * columns;
+    grid_stencil::forEachRowSpan(
+        first, columns, first - columns, first + columns, true, true, [&](const Span& s) {
+          updateWindKernel(s.n,
+                           getStencil(temperature, s),
+                           getStencil(density, s),
+                           getStencil(east, s),
+                           getStencil(north, s),
+                           coriolis,
+                           c,
+                           next_east + s.begin,
+                           next_north + s.begin);
+        });
+  }
+}
+
+void WeatherSolver::updateAir(Tile& tile) const {
+  const StepConstants c = getStepConstants(parameters, time_step, cell_length);
+  const double* temperature = tile.values[AIR_TEMPERATURE].data();
+  const double* density = tile.values[AIR_DENSITY].data();
+  const double* east = tile.values[WIND_EAST].data();
+  const double* north = tile.values[WIND_NORTH].data();
+  double* next_temperature = tile.next[AIR_TEMPERATURE].data();
+  double* next_density = tile.next[AIR_DENSITY].data();
+  const double* equilibrium = tile.equilibrium.data();
+  for (size_t r = 0; r < tile.num_rows; r++) {
+    const size_t first = (r + 1) * columns;
+    grid_stencil::forEachRowSpan(
+        first, columns, first - columns, first + columns, true, true, [&](const Span& s) {
+          updateAirKernel(s.n,
+                          getStencil(temperature, s),
+                          getStencil(density, s),
+                          getStencil(east, s),
+                          getStencil(north, s),
+                          // without halo rows
+                          equilibrium + (s.begin - columns),
+                          c,
+                          next_temperature + s.begin,
+                          next_density + s.begin);
+        });
+  }
+}
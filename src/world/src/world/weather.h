@@ -0,0 +1,150 @@
+#ifndef WEATHER
+#define WEATHER
+
+#include <cstddef>
+#include <utils/taskScheduler.hpp>
+#include <vector>
+
+#include "cellGrid.h"
+
+struct WeatherParameters {
+  // [m]
+  double planet_radius = 6.371e6;
+  // [rad/s]
+  double rotation = 7.292e-5;
+  // [J/(kg K)] of dry air
+  double gas_constant = 287.05;
+  // [K] the air is heated towards these at sea level
+  double equator_temperature = 300.;
+  double pole_temperature = 250.;
+  // [K/m] the equilibrium temperature drops by it above sea level
+  double lapse_rate = 6.5e-3;
+  // [s] how fast the temperature approaches its equilibrium
+  double relaxation_time = 2. * 86400.;
+  // [s] how fast the ground slows the wind down
+  double friction_time = 86400.;
+  // fraction of the difference to the mean of the 4 neighbours removed per step, damps the
+  // short waves the explicit steps can not resolve
+  double smoothing = 0.05;
+  // [m/s] upper bound of sound speed plus wind, limits the time step
+  double max_speed = 400.;
+  // time step times max_speed per cell length, < 1
+  double courant = 0.5;
+};
+
+struct WeatherStats {
+  size_t num_steps = 0;
+  // steps times cells
+  size_t num_cell_updates = 0;
+  // [s] wall clock
+  double duration = 0.;
+  // [s]
+  double simulated_time = 0.;
+
+  double getCellUpdatesPerSecond() const {
+    return (duration > 0.) ? static_cast<double>(num_cell_updates) / duration : 0.;
+  }
+};
+
+/*!
+ * \brief Weather on the AIR layer: the wind (MASS_FLOW_GRADIENT x east and y north [m/s]) is
+ * driven by the pressure of the ideal gas, turned by the Coriolis force and slowed down by
+ * the ground. Temperature and density move with the wind, the temperature is heated
+ * towards an equilibrium which falls towards the poles and with the ground height.
+ * The grid is laid out as in GridGeometry, the cells are treated as squares of equal size,
+ * the distortion towards the poles is ignored (as in erosion::ShallowWater).
+ *
+ * The rows are split into tiles, each tile keeps its own copy of its rows plus one halo row
+ * below and above. A step is two passes (forward-backward): the wind from the pressure, then
+ * temperature and density with the new wind. At the start of a pass every tile pulls the
+ * halos of the fields the previous pass changed from the neighbouring tiles, then computes
+ * its rows with vectorized stencil kernels (see grid_stencil). Tiles only write their own
+ * rows, thus they run in parallel and the result does not depend on the number of threads.
+ */
+class WeatherSolver {
+ public:
+  WeatherSolver() = default;
+
+  explicit WeatherSolver(const WeatherParameters& parameters) : parameters(parameters) {}
+
+  /*!
+   * \brief Copies temperature, density and wind of the AIR layer into the tiles. The GROUND
+   * height sets the equilibrium temperature.
+   */
+  void load(const CellGrid& grid);
+
+  /*!
+   * \brief Writes temperature, density and wind back to the AIR layer, together with the
+   * temperature and density gradients [1/m] used by CellGrid::step().
+   * The grid needs the number of cells of load().
+   */
+  void store(CellGrid& grid);
+
+  /*!
+   * \brief Sets the AIR temperature of every cell to the temperature the weather heats it
+   * towards, from its latitude and GROUND height. A calm start for a new world.
+   */
+  void setEquilibriumTemperature(CellGrid& grid) const;
+
+  /*!
+   * \brief Advances the loaded weather by at least duration in steps of getTimeStep().
+   * \param duration [s]
+   * \param scheduler Runs the tiles in parallel.
+   */
+  WeatherStats simulate(double duration, utils::TaskScheduler& scheduler);
+
+  /*!
+   * \brief [s] of one step, from the cell size and the courant number.
+   */
+  double getTimeStep() const { return time_step; }
+
+  size_t getNumTiles() const { return tiles.size(); }
+
+  const WeatherParameters& getParameters() const { return parameters; }
+
+ private:
+  enum Field { AIR_TEMPERATURE, AIR_DENSITY, WIND_EAST, WIND_NORTH, NUM_FIELDS };
+
+  struct Tile {
+    size_t first_row = 0;
+    size_t num_rows = 0;
+    // (num_rows + 2) * columns values, the first and the last row are the halo
+    std::vector<double> values[NUM_FIELDS];
+    std::vector<double> next[NUM_FIELDS];
+    // [K] num_rows * columns, the temperature the air is heated towards
+    std::vector<double> equilibrium;
+    // [1/s] per row, the Coriolis parameter
+    std::vector<double> coriolis;
+  };
+
+  /*!
+   * \brief Copies the rows next to the tile from its neighbours into its halo rows. At the
+   * poles the halo mirrors the tile's own edge row, the wind to the north is reversed such
+   * that no air flows across the pole.
+   */
+  void pullHalo(size_t tile, Field field);
+
+  /*!
+   * \brief [K] at the height [m] above the sea level and at z of the unit sphere.
+   */
+  double getEquilibriumTemperature(double z, double height) const;
+
+  void updateWind(Tile& tile) const;
+  void updateAir(Tile& tile) const;
+
+  WeatherParameters parameters;
+  std::vector<Tile> tiles;
+  size_t rows = 0;
+  size_t columns = 0;
+  size_t num_cells = 0;
+  // [m]
+  double cell_length = 0.;
+  // [s]
+  double time_step = 0.;
+
+  static constexpr size_t CELLS_PER_TILE = 8192;
+  // tiles have at least this many rows, else the halos cost more than the rows
+  static constexpr size_t MIN_ROWS_PER_TILE = 4;
+};
+
+#endif
@@ -1,24 +1,355 @@
 #include "world.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <globals/globals.hpp>
 #include <globals/macros.hpp>
+#include <utils/hash.hpp>
 
-World::World() {}
+#include "gridGeometry.h"
+#include "noise.h"
 
+World::World() : scheduler(std::make_unique<utils::TaskScheduler>()) {}
 
-void World::init() {}
+
+void World::init() {
+  grid.resize(DEFAULT_NUM_CELLS);
+  for (int l = 0; l < NUM_LAYER_TYPES; l++) {
+    const LayerTyp layer = static_cast<LayerTyp>(l);
+    grid.fill(layer, TEMPERATURE, DEFAULT_TEMPERATURE_K);
+    grid.fill(layer, DENSITY, DEFAULT_DENSITY_KG_M3[l]);
+  }
+  double* ground_height = grid.getField(GROUND, HEIGHT);
+  generateTerrain(ground_height, grid.getNumCells(), seed, *scheduler);
+  weather.setEquilibriumTemperature(grid);
+  // The area types set how strong the ground erodes.
+  classifyBiomes();
+  std::vector<float> strength(grid.getNumCells());
+  biome::getErosionStrength(biomes.data(), biomes.size(), strength.data());
+  if (erosion_solver == erosion::SHALLOW_WATER_SOLVER) {
+    erosion::ShallowWater solver;
+    erosion_stats = solver.run(grid, strength.data(), EROSION_SHALLOW_WATER_STEPS, *scheduler);
+  } else {
+    erosion_stats = erosion::erode(ground_height,
+                                   strength.data(),
+                                   grid.getNumCells(),
+                                   EROSION_DROPLETS_PER_CELL * grid.getNumCells(),
+                                   utils::hash(seed + 1),
+                                   *scheduler);
+  }
+  // valleys, lakes and the temperature of the changed heights
+  weather.setEquilibriumTemperature(grid);
+  classifyBiomes();
+  createTiles();
+  plants.resize(grid.getNumCells());
+  plants.sow(DEFAULT_NUM_PLANTS, tick);
+  creatures.resize(grid.getNumCells(), simulation_time);
+  creatures.spawn(DEFAULT_NUM_CREATURES, tick, simulation_time);
+  resetSchedule();
+  // a new world, the previous checkpoints are no base for deltas of it
+  checkpointer.resetReference();
+}
+
+WeatherStats World::simulateWeather(double duration) {
+  // The tiles of the simulation change the AIR layer too, load it every time.
+  weather.load(grid);
+  const WeatherStats stats = weather.simulate(duration, *scheduler);
+  weather.store(grid);
+  invalidateSnapshots();
+  return stats;
+}
+
+PresimulationStats World::presimulate(const PresimulationSettings& settings,
+                                      const std::string& file) {
+  const auto start = std::chrono::steady_clock::now();
+  PresimulationStats stats;
+  ConvergenceMonitor monitor(settings.convergence);
+  monitor.check(grid, *scheduler);
+  // The terrain was shaped by init(), only the lakes and rivers settle. Erosion goes on for
+  // ages, the world would never settle with it.
+  erosion::ShallowWaterParameters water_parameters;
+  water_parameters.erosion = 0.;
+  water_parameters.deposition = 0.;
+  erosion::ShallowWater water(water_parameters);
+  const bool has_water =
+      erosion_solver == erosion::SHALLOW_WATER_SOLVER && settings.water_steps_per_check > 0;
+
+  while (stats.simulated_time < settings.max_duration && !monitor.isSettled()) {
+    stats.simulated_time += simulateWeather(settings.check_interval).simulated_time;
+    if (has_water) {
+      water.run(grid, nullptr, settings.water_steps_per_check, *scheduler);
+      invalidateSnapshots();
+    }
+    monitor.check(grid, *scheduler);
+  }
+  stats.settled = monitor.isSettled();
+  stats.num_checks = monitor.getNumChecks() - 1;
+  stats.residuals = monitor.getResiduals();
+  F_DEBUG("Presimulated %.1f days, residuals %.3e m and %.3e K, %s.",
+          stats.simulated_time / 86400.,
+          stats.residuals.height,
+          stats.residuals.temperature,
+          stats.settled ? "settled" : "not settled");
+
+  classifyBiomes();
+
+  if (stats.settled && !file.empty()) {
+    stats.saved = save(file);
+    if (!stats.saved) {
+      F_ERROR("Failed to save the presimulated world to %s.", file.c_str());
+    }
+  }
+  stats.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+void World::classifyBiomes() {
+  biomes.resize(grid.getNumCells());
+  biome::classify(grid, utils::hash(seed + 2), *scheduler, biomes.data());
+}
+
+void World::setNumThreads(unsigned int num_threads) {
+  scheduler = std::make_unique<utils::TaskScheduler>(num_threads);
+}
+
+void World::generateTerrain(double* height,
+                            size_t num_cells,
+                            uint64_t seed,
+                            utils::TaskScheduler& scheduler) {
+  // The first octave spans continents, 12 octaves reach about 1/4000 of the circumference.
+  noise::Fractal fractal;
+  fractal.octaves = 12;
+  fractal.frequency = 1.5f;
+  const uint32_t noise_seed = static_cast<uint32_t>(utils::hash(seed));
+  const size_t num_tasks = (num_cells + TERRAIN_CELLS_PER_TASK - 1) / TERRAIN_CELLS_PER_TASK;
+  scheduler.parallelFor(num_tasks, [=, &fractal](size_t task) {
+    const size_t begin = task * TERRAIN_CELLS_PER_TASK;
+    const size_t n = std::min(num_cells, begin + TERRAIN_CELLS_PER_TASK) - begin;
+    std::vector<float> x(n);
+    std::vector<float> y(n);
+    std::vector<float> z(n);
+    std::vector<float> values(n);
+    GridGeometry::getCellCenters(
+        begin, begin + n, static_cast<uint32_t>(num_cells), x.data(), y.data(), z.data());
+    noise::fractal(n, x.data(), y.data(), z.data(), fractal, noise_seed, values.data());
+    for (size_t i = 0; i < n; i++) {
+      height[begin + i] = TERRAIN_AMPLITUDE_M * values[i];
+    }
+  });
+}
+
+void World::createTiles() {
+  tiles.clear();
+  const size_t num_cells = grid.getNumCells();
+  tiles.reserve((num_cells + CELLS_PER_TILE - 1) / CELLS_PER_TILE);
+  for (size_t begin = 0; begin < num_cells; begin += CELLS_PER_TILE) {
+    const size_t end = std::min(begin + CELLS_PER_TILE, num_cells);
+    tiles.emplace_back(simulation_time, &grid, begin, end);
+  }
+  tile_is_due.assign(tiles.size(), 0);
+  tile_changed.resize(tiles.size());
+  invalidateSnapshots();
+}
+
+void World::resetSchedule() {
+  unit_schedule.reset(tick);
+  for (size_t i = 0; i < tiles.size(); i++) {
+    schedule({ScheduledUnit::TILE, static_cast<uint32_t>(i)}, simulation_time);
+  }
+  schedule({ScheduledUnit::CREATURES, 0}, simulation_time);
+  plants_last_update = simulation_time;
+  schedule({ScheduledUnit::PLANTS, 0}, simulation_time);
+}
+
+void World::schedule(const ScheduledUnit& unit, tool::PreciseTime next_update) {
+  const double until_due = std::chrono::duration<double>(next_update - simulation_time).count();
+  const double ticks_until_due = std::ceil(until_due / time_step);
+  unit_schedule.schedule(unit, tick + static_cast<uint64_t>(std::max(ticks_until_due, 1.)));
+}
+
+void World::invalidateSnapshots() {
+  // Every snapshot buffer was written before the next update().
+  std::fill(tile_changed.begin(), tile_changed.end(), update_count + 1);
+}
 
 void World::update() {
-  // todo do calculations
+  const auto start = std::chrono::steady_clock::now();
+  simulation_time += std::chrono::duration_cast<tool::PreciseTime>(
+      std::chrono::duration<double>(time_step));
+  tick++;
+  update_count++;
+
+  CellGrid* frozen_grid = nullptr;
+  if (checkpoint_requested.load() && !checkpointer.isBusy()) {
+    frozen_grid = &checkpointer.beginFreeze(grid.getNumCells());
+  }
+  WorldSnapshot* snapshot = nullptr;
+  // The buffer still holds what it was filled with the last time it was written.
+  uint64_t snapshot_update_count = 0;
+  if (publish_snapshots) {
+    snapshot = &snapshots.getWriteBuffer();
+    snapshot_update_count = snapshot->update_count;
+    prepareSnapshot(*snapshot);
+  }
+
+  due_units.clear();
+  unit_schedule.advance(due_units);
+  due_tiles.clear();
+  bool creatures_are_due = false;
+  bool plants_are_due = false;
+  for (const ScheduledUnit& unit : due_units) {
+    switch (unit.type) {
+      case ScheduledUnit::TILE:
+        due_tiles.push_back(unit.index);
+        break;
+      case ScheduledUnit::CREATURES:
+        creatures_are_due = true;
+        break;
+      case ScheduledUnit::PLANTS:
+        plants_are_due = true;
+        break;
+    }
+  }
+
+  // All tiles are independent within one time step (see SimulatedUnit).
+  // parallelFor returns after every tile was simulated.
+  if (snapshot == nullptr && frozen_grid == nullptr) {
+    scheduler->parallelFor(due_tiles.size(),
+                           [this](size_t i) { tiles[due_tiles[i]].simulate(simulation_time); });
+  } else {
+    // A checkpoint needs every tile, the snapshot the tiles which changed since its buffer
+    // was written. Each tile copies its result while it is still in cache.
+    visited_tiles.clear();
+    for (const size_t i : due_tiles) {
+      tile_is_due[i] = 1;
+    }
+    for (size_t i = 0; i < tiles.size(); i++) {
+      if (tile_is_due[i] || frozen_grid != nullptr || tile_changed[i] > snapshot_update_count) {
+        visited_tiles.push_back(i);
+      }
+    }
+    scheduler->parallelFor(visited_tiles.size(), [this, snapshot, frozen_grid](size_t v) {
+      const size_t i = visited_tiles[v];
+      GridTile& tile = tiles[i];
+      if (tile_is_due[i]) {
+        tile.simulate(simulation_time);
+        tile_is_due[i] = 0;
+      }
+      if (snapshot != nullptr) {
+        copyToSnapshot(tile, *snapshot);
+      }
+      if (frozen_grid != nullptr) {
+        frozen_grid->copyCells(grid, tile.getBegin(), tile.getEnd());
+      }
+    });
+  }
+  for (const size_t i : due_tiles) {
+    tile_changed[i] = update_count;
+    schedule({ScheduledUnit::TILE, static_cast<uint32_t>(i)}, tiles[i].getNextUpdateTime());
+  }
+  // Creatures graze first, the plants lose the grazed biomass during their update.
+  if (creatures_are_due) {
+    creatures.update(simulation_time, *scheduler, plants);
+    schedule({ScheduledUnit::CREATURES, 0},
+             simulation_time + std::chrono::duration_cast<tool::PreciseTime>(
+                                   std::chrono::duration<double>(CREATURE_UPDATE_INTERVAL)));
+  }
+  // Plants grow with the ground temperature of this step.
+  if (plants_are_due) {
+    const double dt = std::chrono::duration<double>(simulation_time - plants_last_update).count();
+    plants.update(dt, grid, *scheduler, tick, biomes.data());
+    plants_last_update = simulation_time;
+    schedule({ScheduledUnit::PLANTS, 0},
+             simulation_time + std::chrono::duration_cast<tool::PreciseTime>(
+                                   std::chrono::duration<double>(PLANT_UPDATE_INTERVAL)));
+  }
+
+  if (snapshot != nullptr) {
+    snapshot->wall_time = std::chrono::steady_clock::now();
+    snapshots.publish();
+  }
+  if (frozen_grid != nullptr) {
+    std::string file;
+    {
+      std::lock_guard<std::mutex> lock(checkpoint_file_mutex);
+      file = checkpoint_file;
+      checkpoint_requested = false;
+    }
+    checkpointer.commitFreeze(file, getWorldInfo());
+  }
+
+  const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+  checkpointer.recordTick(duration.count(), frozen_grid != nullptr);
+}
+
+void World::requestCheckpoint(const std::string& file) {
+  std::lock_guard<std::mutex> lock(checkpoint_file_mutex);
+  checkpoint_file = file;
+  checkpoint_requested = true;
+}
+
+void World::prepareSnapshot(WorldSnapshot& snapshot) const {
+  snapshot.tick = tick;
+  snapshot.update_count = update_count;
+  snapshot.simulation_time = std::chrono::duration<double>(simulation_time).count();
+  for (int l = 0; l < NUM_LAYER_TYPES; l++) {
+    snapshot.height[l].resize(grid.getNumCells());
+    snapshot.temperature[l].resize(grid.getNumCells());
+  }
+}
+
+void World::copyToSnapshot(const GridTile& tile, WorldSnapshot& snapshot) const {
+  for (int l = 0; l < NUM_LAYER_TYPES; l++) {
+    const LayerTyp layer = static_cast<LayerTyp>(l);
+    const double* height = grid.getField(layer, HEIGHT);
+    const double* temperature = grid.getField(layer, TEMPERATURE);
+    std::copy(height + tile.getBegin(),
+              height + tile.getEnd(),
+              snapshot.height[l].begin() + tile.getBegin());
+    std::copy(temperature + tile.getBegin(),
+              temperature + tile.getEnd(),
+              snapshot.temperature[l].begin() + tile.getBegin());
+  }
 }
 
 bool World::save(const std::string& file) {
   F_DEBUG("Saving world to %s.", file.c_str());
-  return false;
+  // The file may be part of the chain the next checkpoint would be a delta on.
+  checkpointer.resetReference();
+  return world_file::save(file, grid, getWorldInfo());
 }
 
 
-bool World::load(const std::string& file) { return false; }
+bool World::load(const std::string& file) {
+  world_file::WorldInfo info;
+  if (!world_file::load(file, grid, info)) {
+    return false;
+  }
+  tick = info.tick;
+  simulation_time = std::chrono::duration_cast<tool::PreciseTime>(
+      std::chrono::duration<double>(info.simulation_time));
+  time_step = info.time_step;
+  // Not part of the world file, they follow from the grid and the seed of setSeed().
+  classifyBiomes();
+  createTiles();
+  // Plants and creatures are not part of the world file yet, start new populations.
+  plants.resize(grid.getNumCells());
+  plants.sow(DEFAULT_NUM_PLANTS, tick);
+  creatures.resize(grid.getNumCells(), simulation_time);
+  creatures.spawn(DEFAULT_NUM_CREATURES, tick, simulation_time);
+  resetSchedule();
+  checkpointer.resetReference();
+  return true;
+}
+
+world_file::WorldInfo World::getWorldInfo() const {
+  world_file::WorldInfo info;
+  info.tick = tick;
+  info.simulation_time = std::chrono::duration<double>(simulation_time).count();
+  info.time_step = time_step;
+  return info;
+}
 
 bool World::load_mesh(const std::string& mesh_file) {
   WARNING("TODO");
@@ -1,10 +1,54 @@
 #ifndef WORLD
 #define WORLD
 
-#include <display_elements/worldMesh.h>
-
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utils/taskScheduler.hpp>
+#include <utils/timingWheel.hpp>
+#include <utils/tripleBuffer.hpp>
+#include <vector>
+
+#include "biome.h"
+#include "cellGrid.h"
+#include "checkpointer.h"
+#include "convergenceMonitor.h"
+#include "creature.h"
+#include "erosion.h"
+#include "gridTile.h"
+#include "plant.h"
+#include "shallowWater.h"
+#include "weather.h"
+#include "worldFile.h"
+#include "worldSnapshot.h"
+
+// The world only hands its mesh through. Not including the mesh keeps the
+// simulation free of any display dependencies (see evosym_headless).
+class BaseMesh;
+
+struct PresimulationSettings {
+  // [s] of weather between two checks of the ConvergenceMonitor
+  double check_interval = 6. * 3600.;
+  // [s] of weather after which the presimulation gives up if the world did not settle
+  double max_duration = 60. * 86400.;
+  // steps of erosion::ShallowWater (without erosion) between two checks if init() eroded with
+  // it, lakes and rivers settle, 0 = none
+  size_t water_steps_per_check = 100;
+  ConvergenceSettings convergence;
+};
+
+struct PresimulationStats {
+  bool settled = false;
+  bool saved = false;
+  size_t num_checks = 0;
+  // [s] of weather
+  double simulated_time = 0.;
+  // [s] wall clock
+  double duration = 0.;
+  // of the last check
+  Residuals residuals;
+};
 
 class World {
  public:
@@ -20,11 +64,254 @@ class World {
 
   std::shared_ptr<BaseMesh> getWorldsMesh() const { return world_mesh; }
 
+  /*!
+   * \brief Saves the world in the binary world file format, see worldFile.h.
+   * Waits for a running checkpoint, the next one is a full file since file may have replaced
+   * one it would depend on.
+   * \param file The path to the file.
+   * \return True on success.
+   */
   [[nodiscard]] bool save(const std::string& file);
+
+  /*!
+   * \brief Loads a world saved with save(). The grid is memory mapped, values are only
+   * read from disk once they are accessed. Plants and creatures are not saved yet, new
+   * populations are created.
+   * \param file The path to the file.
+   * \return True on success. On failure the world is unchanged.
+   */
   [[nodiscard]] bool load(const std::string& file);
 
+  /*!
+   * \brief Saves the world without stopping the simulation. Thread safe.
+   * The next update() copies each tile into a frozen grid right after simulating it,
+   * a background thread writes the frozen grid into file while update() continues.
+   * If a checkpoint is still being written, the copy is delayed until it is finished.
+   * \param file The path to the file.
+   */
+  void requestCheckpoint(const std::string& file);
+
+  /*!
+   * \brief Blocks until no checkpoint is being written. A requested checkpoint which was
+   * not frozen yet (no update() since the request) is not waited for.
+   */
+  void waitForCheckpoint() { checkpointer.waitUntilIdle(); }
+
+  bool isCheckpointRequested() const { return checkpoint_requested.load(); }
+
+  /*!
+   * \brief Thread safe. Every interval-th checkpoint is a full file, the others only hold
+   * the changes since the previous checkpoint. See Checkpointer::setKeyframeInterval().
+   */
+  void setCheckpointKeyframeInterval(unsigned int interval) {
+    checkpointer.setKeyframeInterval(interval);
+  }
+
+  /*!
+   * \brief Thread safe statistic about written checkpoints and their impact on tick duration.
+   */
+  CheckpointStats getCheckpointStats() const { return checkpointer.getStats(); }
+
+  /*!
+   * \brief Thread safe. Which checkpoints were written or failed since the last call.
+   */
+  std::vector<CheckpointResult> takeCheckpointResults() { return checkpointer.takeResults(); }
+
+  const CreaturePopulation& getCreatures() const { return creatures; }
+  CreaturePopulation& getCreatures() { return creatures; }
+
+  const PlantPopulation& getPlants() const { return plants; }
+  PlantPopulation& getPlants() { return plants; }
+
+  const CellGrid& getGrid() const { return grid; }
+
+  /*!
+   * \brief The next snapshots copy every tile again, since the caller may change any cell.
+   */
+  CellGrid& getGrid() {
+    invalidateSnapshots();
+    return grid;
+  }
+
+  /*!
+   * \brief The tiles of the grid, each tile sets its own update intervall.
+   */
+  const std::vector<GridTile>& getTiles() const { return tiles; }
+
+  /*!
+   * \brief Sets the number of threads update() distributes the tiles on.
+   * \param num_threads The number of threads, 0 means one per hardware core.
+   */
+  void setNumThreads(unsigned int num_threads);
+
+  unsigned int getNumThreads() const { return scheduler->getNumThreads(); }
+
+  /*!
+   * \brief Returns the state published by the latest finished update().
+   * Never blocks update() and vice versa. Must only be called from one thread
+   * (the render thread). The returned reference stays valid until the next call.
+   */
+  const WorldSnapshot& readSnapshot() { return snapshots.read(); }
+
+  /*!
+   * \brief True if update() published a snapshot since the last readSnapshot().
+   */
+  bool hasNewSnapshot() const { return snapshots.hasNewData(); }
+
+  /*!
+   * \brief Without a reader (e.g. no display) copying the snapshots can be switched off.
+   */
+  void setPublishSnapshots(bool publish) { publish_snapshots = publish; }
+
+  uint64_t getTick() const { return tick; }
+
+  /*!
+   * \brief The seed of the terrain of the next init().
+   */
+  void setSeed(uint64_t seed) { this->seed = seed; }
+
+  uint64_t getSeed() const { return seed; }
+
+  /*!
+   * \brief Fills the ground height of every cell with fractal noise, see noise.h.
+   * Deterministic: the same seed gives the same terrain on any number of threads.
+   * \param height [m] The ground heights of num_cells cells laid out as in GridGeometry.
+   * \param scheduler Splits the cells into blocks which are generated in parallel.
+   */
+  static void generateTerrain(double* height,
+                              size_t num_cells,
+                              uint64_t seed,
+                              utils::TaskScheduler& scheduler);
+
+  /*!
+   * \brief Selects how the next init() erodes the terrain: by droplets (erosion.h, the
+   * default) or by water flowing on the grid (shallowWater.h), which also leaves lakes and
+   * rivers in the WATER layer.
+   */
+  void setErosionSolver(erosion::Solver solver) { erosion_solver = solver; }
+
+  erosion::Solver getErosionSolver() const { return erosion_solver; }
+
+  /*!
+   * \brief How the last init() eroded the terrain.
+   */
+  const erosion::Stats& getErosionStats() const { return erosion_stats; }
+
+  /*!
+   * \brief The biome of every cell (see biome.h), one byte per cell. Classified by init(),
+   * load() and presimulate(), or by classifyBiomes().
+   */
+  const std::vector<uint8_t>& getBiomes() const { return biomes; }
+
+  /*!
+   * \brief Classifies the biomes again from the current grid, e.g. after simulateWeather().
+   */
+  void classifyBiomes();
+
+  /*!
+   * \brief Runs the weather of the AIR layer for duration seconds, see weather.h. Not
+   * thread safe with update().
+   * \param duration [s]
+   */
+  WeatherStats simulateWeather(double duration);
+
+  /*!
+   * \brief Runs the weather (and the water if init() eroded with erosion::ShallowWater, but no
+   * more erosion) in chunks of check_interval until the ConvergenceMonitor finds the world
+   * settled or max_duration is reached. The biomes are classified again for the settled
+   * climate. A settled world is saved, such that later runs can start from it instead of
+   * presimulating again. Not thread safe with update().
+   * \param settings The check interval, the limit and the tolerances.
+   * \param file The settled world is saved there, an empty path saves nothing.
+   * \return Whether the world settled and was saved, and how long it took.
+   */
+  PresimulationStats presimulate(const PresimulationSettings& settings, const std::string& file);
 
  private:
+  // An entry of the schedule: one tile, all creatures or all plants.
+  struct ScheduledUnit {
+    enum Type : uint32_t { TILE, CREATURES, PLANTS };
+    Type type;
+    // of the tile
+    uint32_t index;
+  };
+
+  void createTiles();
+
+  /*!
+   * \brief Restarts the schedule with every tile, the creatures and the plants due with the
+   * next update().
+   */
+  void resetSchedule();
+
+  /*!
+   * \brief Schedules the unit for the first tick at which it is due.
+   * \param next_update The simulation time of its next update.
+   */
+  void schedule(const ScheduledUnit& unit, tool::PreciseTime next_update);
+
+  /*!
+   * \brief Marks all tiles as changed, e.g. after the grid was changed outside of update().
+   */
+  void invalidateSnapshots();
+
+  world_file::WorldInfo getWorldInfo() const;
+
+  void prepareSnapshot(WorldSnapshot& snapshot) const;
+  void copyToSnapshot(const GridTile& tile, WorldSnapshot& snapshot) const;
+
   std::shared_ptr<BaseMesh> world_mesh = nullptr;
+
+  CellGrid grid;
+  std::vector<GridTile> tiles;
+  PlantPopulation plants;
+  CreaturePopulation creatures;
+  std::unique_ptr<utils::TaskScheduler> scheduler;
+  // Units by the tick they are due, an update() only visits the due ones.
+  utils::TimingWheel<ScheduledUnit> unit_schedule;
+  std::vector<ScheduledUnit> due_units;
+  std::vector<size_t> due_tiles;
+  std::vector<char> tile_is_due;
+  // tiles which are due or not yet copied into the current snapshot
+  std::vector<size_t> visited_tiles;
+  // per tile: the update_count of its last change, see WorldSnapshot::update_count
+  std::vector<uint64_t> tile_changed;
+  tool::PreciseTime plants_last_update = tool::PreciseTime();
+  // number of update() calls, unlike tick never reset by load()
+  uint64_t update_count = 0;
+
+  // [s] simulated time per update()
+  double time_step = 1.;
+  tool::PreciseTime simulation_time = tool::PreciseTime();
+  uint64_t tick = 0;
+  uint64_t seed = 0;
+  erosion::Solver erosion_solver = erosion::DROPLET_SOLVER;
+  erosion::Stats erosion_stats;
+  WeatherSolver weather;
+  std::vector<uint8_t> biomes;
+
+  utils::TripleBuffer<WorldSnapshot> snapshots;
+  bool publish_snapshots = true;
+
+  Checkpointer checkpointer;
+  std::atomic<bool> checkpoint_requested{false};
+  std::mutex checkpoint_file_mutex;
+  std::string checkpoint_file;
+
+  // [s]
+  static constexpr double CREATURE_UPDATE_INTERVAL = 1.;
+  static constexpr double PLANT_UPDATE_INTERVAL = 10.;
+  static constexpr size_t DEFAULT_NUM_CELLS = 1 << 16;
+  static constexpr size_t CELLS_PER_TILE = 4096;
+  static constexpr size_t DEFAULT_NUM_PLANTS = 1 << 18;
+  static constexpr size_t DEFAULT_NUM_CREATURES = 1 << 14;
+  static constexpr size_t TERRAIN_CELLS_PER_TASK = 4096;
+  // [m] the highest mountain and the deepest sea floor
+  static constexpr float TERRAIN_AMPLITUDE_M = 8000.f;
+  static constexpr size_t EROSION_DROPLETS_PER_CELL = 4;
+  static constexpr size_t EROSION_SHALLOW_WATER_STEPS = 2000;
+  // initial values per LayerTyp
+  static constexpr double DEFAULT_TEMPERATURE_K = 288.15;
+  static constexpr double DEFAULT_DENSITY_KG_M3[NUM_LAYER_TYPES] = {1.225, 1000., 2700.};
 };
 #endif
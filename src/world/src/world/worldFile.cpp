@@ -0,0 +1,340 @@
+#include "worldFile.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <globals/macros.hpp>
+#include <vector>
+
+namespace world_file {
+
+namespace {
+
+constexpr uint64_t NUM_FIELDS = static_cast<uint64_t>(NUM_LAYER_TYPES) * NUM_GRID_FIELDS;
+
+uint64_t alignUp(uint64_t value) {
+  return (value + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT;
+}
+
+bool writePadding(FILE* f, uint64_t from, uint64_t to) {
+  static const char zeros[CHUNK_ALIGNMENT] = {};
+  return to - from == 0 || fwrite(zeros, 1, to - from, f) == to - from;
+}
+
+// One chunk to be written: its header and the pieces of memory forming its data.
+struct ChunkData {
+  ChunkHeader header;
+  std::vector<std::pair<const void*, uint64_t>> pieces;
+};
+
+bool writeFile(const std::string& file, const WorldInfo& info, std::vector<ChunkData>& chunks) {
+  FileHeader header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.byte_order_mark = BYTE_ORDER_MARK;
+  header.num_chunks = static_cast<uint32_t>(chunks.size());
+  header.reserved = 0;
+  header.tick = info.tick;
+  header.simulation_time = info.simulation_time;
+  header.time_step = info.time_step;
+
+  uint64_t offset = alignUp(sizeof(FileHeader) + chunks.size() * sizeof(ChunkHeader));
+  for (auto& chunk : chunks) {
+    chunk.header.reserved = 0;
+    chunk.header.offset = offset;
+    chunk.header.size = 0;
+    for (const auto& piece : chunk.pieces) {
+      chunk.header.size += piece.second;
+    }
+    offset = alignUp(offset + chunk.header.size);
+  }
+
+  const std::string tmp_file = file + ".tmp";
+  FILE* f = fopen(tmp_file.c_str(), "wb");
+  if (f == nullptr) {
+    F_ERROR("Failed to open %s for writing.", tmp_file.c_str());
+    return false;
+  }
+
+  bool success = fwrite(&header, sizeof(header), 1, f) == 1;
+  uint64_t position = sizeof(header);
+  for (const auto& chunk : chunks) {
+    success = success && fwrite(&chunk.header, sizeof(ChunkHeader), 1, f) == 1;
+    position += sizeof(ChunkHeader);
+  }
+  for (const auto& chunk : chunks) {
+    success = success && writePadding(f, position, chunk.header.offset);
+    position = chunk.header.offset;
+    for (const auto& piece : chunk.pieces) {
+      if (piece.second > 0) {
+        success = success && fwrite(piece.first, piece.second, 1, f) == 1;
+      }
+      position += piece.second;
+    }
+  }
+  success = (fclose(f) == 0) && success;
+  if (!success) {
+    F_ERROR("Failed to write %s.", tmp_file.c_str());
+    std::remove(tmp_file.c_str());
+    return false;
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tmp_file, file, error);
+  if (error) {
+    F_ERROR("Failed to rename %s to %s.", tmp_file.c_str(), file.c_str());
+    return false;
+  }
+  return true;
+}
+
+uint64_t getBlockCells(uint64_t block, uint64_t block_cells, uint64_t num_cells) {
+  return std::min(block_cells, num_cells - block * block_cells);
+}
+
+bool isValidGridChunk(const ChunkHeader& chunk, uint64_t file_size) {
+  const uint64_t num_cells = chunk.parameter[0];
+  return chunk.offset % CHUNK_ALIGNMENT == 0 && chunk.offset + chunk.size <= file_size &&
+         chunk.parameter[1] == CellGrid::getStride(num_cells) &&
+         chunk.parameter[2] == NUM_LAYER_TYPES && chunk.parameter[3] == NUM_GRID_FIELDS &&
+         chunk.size == CellGrid::getSizeBytes(num_cells);
+}
+
+bool isValidDeltaChunk(const ChunkHeader& chunk, const char* bytes, uint64_t file_size) {
+  const uint64_t num_cells = chunk.parameter[0];
+  const uint64_t block_cells = chunk.parameter[1];
+  const uint64_t num_blocks = chunk.parameter[2];
+  if (chunk.offset % CHUNK_ALIGNMENT != 0 || chunk.offset + chunk.size > file_size ||
+      block_cells == 0 || chunk.parameter[3] != NUM_FIELDS ||
+      num_blocks * sizeof(uint64_t) > chunk.size) {
+    return false;
+  }
+  const uint64_t num_all_blocks = (num_cells + block_cells - 1) / block_cells;
+  uint64_t expected_size = num_blocks * sizeof(uint64_t);
+  for (uint64_t b = 0; b < num_blocks; b++) {
+    uint64_t block;
+    std::memcpy(&block, bytes + chunk.offset + b * sizeof(uint64_t), sizeof(block));
+    if (block >= num_all_blocks) {
+      return false;
+    }
+    expected_size += getBlockCells(block, block_cells, num_cells) * NUM_FIELDS * sizeof(double);
+  }
+  return chunk.size == expected_size;
+}
+
+void applyDelta(const ChunkHeader& chunk, const char* bytes, CellGrid& grid) {
+  const uint64_t block_cells = chunk.parameter[1];
+  const uint64_t num_blocks = chunk.parameter[2];
+  const char* blocks = bytes + chunk.offset;
+  const char* values = blocks + num_blocks * sizeof(uint64_t);
+  for (uint64_t b = 0; b < num_blocks; b++) {
+    uint64_t block;
+    std::memcpy(&block, blocks + b * sizeof(uint64_t), sizeof(block));
+    const uint64_t count = getBlockCells(block, block_cells, grid.getNumCells());
+    for (uint64_t f = 0; f < NUM_FIELDS; f++) {
+      std::memcpy(grid.data() + f * grid.getStride() + block * block_cells,
+                  values,
+                  count * sizeof(double));
+      values += count * sizeof(double);
+    }
+  }
+}
+
+bool load(const std::string& file, CellGrid& grid, WorldInfo& info, size_t chain_length) {
+  if (chain_length > MAX_DELTA_CHAIN) {
+    F_ERROR("Failed to load %s: too many deltas since the last keyframe.", file.c_str());
+    return false;
+  }
+  const int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    F_ERROR("Failed to open %s.", file.c_str());
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || static_cast<uint64_t>(file_stat.st_size) < sizeof(FileHeader)) {
+    F_ERROR("%s is not a world file.", file.c_str());
+    close(fd);
+    return false;
+  }
+  const uint64_t file_size = static_cast<uint64_t>(file_stat.st_size);
+
+  // MAP_PRIVATE: the simulation may write into the grid without changing the file.
+  void* mapping = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after closing the file.
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    F_ERROR("Failed to map %s.", file.c_str());
+    return false;
+  }
+  auto fail = [&](const char* reason) {
+    F_ERROR("Failed to load %s: %s", file.c_str(), reason);
+    munmap(mapping, file_size);
+    return false;
+  };
+
+  const char* bytes = static_cast<const char*>(mapping);
+  FileHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+    return fail("not a world file");
+  }
+  if (header.byte_order_mark != BYTE_ORDER_MARK) {
+    return fail("written on a machine with different byte order");
+  }
+  if (header.version != VERSION) {
+    return fail("unsupported version");
+  }
+  if (sizeof(FileHeader) + header.num_chunks * sizeof(ChunkHeader) > file_size) {
+    return fail("truncated chunk table");
+  }
+
+  std::vector<ChunkHeader> chunks(header.num_chunks);
+  std::memcpy(chunks.data(), bytes + sizeof(FileHeader), chunks.size() * sizeof(ChunkHeader));
+  const ChunkHeader* grid_chunk = nullptr;
+  const ChunkHeader* parent_chunk = nullptr;
+  const ChunkHeader* delta_chunk = nullptr;
+  for (const auto& chunk : chunks) {
+    if (chunk.type == CHUNK_GRID) {
+      grid_chunk = &chunk;
+    } else if (chunk.type == CHUNK_PARENT) {
+      parent_chunk = &chunk;
+    } else if (chunk.type == CHUNK_GRID_DELTA) {
+      delta_chunk = &chunk;
+    }
+  }
+
+  if (grid_chunk != nullptr) {
+    if (!isValidGridChunk(*grid_chunk, file_size)) {
+      return fail("corrupt grid chunk");
+    }
+    double* grid_memory =
+        reinterpret_cast<double*>(static_cast<char*>(mapping) + grid_chunk->offset);
+    grid.adopt(grid_memory, grid_chunk->parameter[0], [mapping, file_size](double*) {
+      munmap(mapping, file_size);
+    });
+  } else {
+    if (parent_chunk == nullptr || delta_chunk == nullptr) {
+      return fail("missing grid chunk");
+    }
+    if (parent_chunk->offset + parent_chunk->size > file_size ||
+        !isValidDeltaChunk(*delta_chunk, bytes, file_size)) {
+      return fail("corrupt delta chunk");
+    }
+    const std::filesystem::path parent_path(
+        std::string(bytes + parent_chunk->offset, parent_chunk->size));
+    const std::string parent_file =
+        (std::filesystem::path(file).parent_path() / parent_path).string();
+
+    CellGrid parent_grid;
+    WorldInfo parent_info;
+    if (!load(parent_file, parent_grid, parent_info, chain_length + 1)) {
+      return fail("failed to load the parent checkpoint");
+    }
+    if (parent_info.tick != parent_chunk->parameter[0] ||
+        parent_grid.getNumCells() != delta_chunk->parameter[0]) {
+      return fail("the parent checkpoint was replaced");
+    }
+    applyDelta(*delta_chunk, bytes, parent_grid);
+    munmap(mapping, file_size);
+    grid = std::move(parent_grid);
+  }
+
+  info.tick = header.tick;
+  info.simulation_time = header.simulation_time;
+  info.time_step = header.time_step;
+  return true;
+}
+}  // namespace
+
+bool save(const std::string& file, const CellGrid& grid, const WorldInfo& info) {
+  std::vector<ChunkData> chunks(1);
+  ChunkHeader& grid_chunk = chunks[0].header;
+  grid_chunk.type = CHUNK_GRID;
+  grid_chunk.parameter[0] = grid.getNumCells();
+  grid_chunk.parameter[1] = grid.getStride();
+  grid_chunk.parameter[2] = NUM_LAYER_TYPES;
+  grid_chunk.parameter[3] = NUM_GRID_FIELDS;
+  chunks[0].pieces.emplace_back(grid.data(), grid.getSizeBytes());
+  return writeFile(file, info, chunks);
+}
+
+std::vector<uint64_t> getChangedBlocks(const CellGrid& grid,
+                                       const CellGrid& reference,
+                                       uint64_t block_cells) {
+  std::vector<uint64_t> changed_blocks;
+  if (grid.getNumCells() != reference.getNumCells() || block_cells == 0) {
+    ERROR("The grids can not be compared.");
+    return changed_blocks;
+  }
+  const uint64_t num_cells = grid.getNumCells();
+  const uint64_t num_blocks = (num_cells + block_cells - 1) / block_cells;
+  for (uint64_t block = 0; block < num_blocks; block++) {
+    const uint64_t begin = block * block_cells;
+    const uint64_t bytes = getBlockCells(block, block_cells, num_cells) * sizeof(double);
+    for (uint64_t f = 0; f < NUM_FIELDS; f++) {
+      const uint64_t offset = f * grid.getStride() + begin;
+      // Bitwise comparison: every change, even of a NaN, is written.
+      if (std::memcmp(grid.data() + offset, reference.data() + offset, bytes) != 0) {
+        changed_blocks.push_back(block);
+        break;
+      }
+    }
+  }
+  return changed_blocks;
+}
+
+bool saveDelta(const std::string& file,
+               const CellGrid& grid,
+               const std::vector<uint64_t>& changed_blocks,
+               const std::string& parent_file,
+               uint64_t parent_tick,
+               const WorldInfo& info,
+               uint64_t block_cells) {
+  // Store the parent relative to the directory of the delta such that a directory of
+  // checkpoints can be moved as a whole.
+  const std::filesystem::path directory =
+      std::filesystem::absolute(std::filesystem::path(file)).parent_path();
+  const std::string parent =
+      std::filesystem::absolute(std::filesystem::path(parent_file))
+          .lexically_relative(directory)
+          .string();
+  if (parent.empty()) {
+    F_ERROR("Can not reference %s from %s.", parent_file.c_str(), file.c_str());
+    return false;
+  }
+
+  const uint64_t num_cells = grid.getNumCells();
+  std::vector<ChunkData> chunks(2);
+  ChunkHeader& parent_chunk = chunks[0].header;
+  parent_chunk.type = CHUNK_PARENT;
+  parent_chunk.parameter[0] = parent_tick;
+  parent_chunk.parameter[1] = parent_chunk.parameter[2] = parent_chunk.parameter[3] = 0;
+  chunks[0].pieces.emplace_back(parent.data(), parent.size());
+
+  ChunkHeader& delta_chunk = chunks[1].header;
+  delta_chunk.type = CHUNK_GRID_DELTA;
+  delta_chunk.parameter[0] = num_cells;
+  delta_chunk.parameter[1] = block_cells;
+  delta_chunk.parameter[2] = changed_blocks.size();
+  delta_chunk.parameter[3] = NUM_FIELDS;
+  chunks[1].pieces.emplace_back(changed_blocks.data(), changed_blocks.size() * sizeof(uint64_t));
+  for (const uint64_t block : changed_blocks) {
+    const uint64_t bytes = getBlockCells(block, block_cells, num_cells) * sizeof(double);
+    for (uint64_t f = 0; f < NUM_FIELDS; f++) {
+      chunks[1].pieces.emplace_back(grid.data() + f * grid.getStride() + block * block_cells,
+                                    bytes);
+    }
+  }
+  return writeFile(file, info, chunks);
+}
+
+bool load(const std::string& file, CellGrid& grid, WorldInfo& info) {
+  return load(file, grid, info, 0);
+}
+}  // namespace world_file
@@ -0,0 +1,134 @@
+#ifndef WORLD_FILE
+#define WORLD_FILE
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cellGrid.h"
+
+/*
+ * Binary world file (*.evsm), all values in native byte order:
+ *
+ * FileHeader
+ * ChunkHeader[num_chunks]
+ * padding up to CHUNK_ALIGNMENT
+ * chunk data, every chunk starts at a multiple of CHUNK_ALIGNMENT
+ *
+ * The GRID chunk is a byte by byte copy of the CellGrid memory block. Since it
+ * starts page aligned, the whole block is memory mapped and used as grid storage
+ * on load. Saving writes the block with one sequential write.
+ *
+ * A delta file has no GRID chunk. Instead its PARENT chunk names the checkpoint it is
+ * based on and its GRID_DELTA chunk holds the blocks of cells which changed since then:
+ * uint64_t block_index[num_blocks], followed for every listed block by the cells of
+ * the block of every field (field major, in the order of the CellGrid block).
+ * Loading a delta loads its parent (recursively down to a full file, the keyframe)
+ * and applies the changed blocks on top of it.
+ */
+namespace world_file {
+
+constexpr char MAGIC[8] = {'E', 'V', 'O', 'S', 'Y', 'M', 'W', 'F'};
+constexpr uint32_t VERSION = 1;
+// Written as is, reads back differently on a machine with another byte order.
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint64_t CHUNK_ALIGNMENT = 4096;
+
+// The number of cells which are compared and stored together in a delta file.
+constexpr uint64_t DELTA_BLOCK_CELLS = 1024;
+// Guards against cyclic parent references. Keyframes should be written far more often.
+constexpr size_t MAX_DELTA_CHAIN = 4096;
+
+enum ChunkType : uint32_t { CHUNK_GRID = 1, CHUNK_PARENT = 2, CHUNK_GRID_DELTA = 3 };
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order_mark;
+  uint32_t num_chunks;
+  uint32_t reserved;
+  uint64_t tick;
+  double simulation_time;
+  double time_step;
+};
+
+struct ChunkHeader {
+  uint32_t type;
+  uint32_t reserved;
+  // [byte] from the start of the file
+  uint64_t offset;
+  // [byte]
+  uint64_t size;
+  // chunk type specific
+  // GRID: num_cells, stride, NUM_LAYER_TYPES, NUM_GRID_FIELDS
+  // PARENT: tick of the parent, the data is its path, relative to the directory of this file
+  // GRID_DELTA: num_cells, cells per block, num_blocks, NUM_LAYER_TYPES * NUM_GRID_FIELDS
+  uint64_t parameter[4];
+};
+
+/*!
+ * \brief The state of the world which is not part of any chunk.
+ */
+struct WorldInfo {
+  uint64_t tick = 0;
+  // [s]
+  double simulation_time = 0.;
+  // [s]
+  double time_step = 1.;
+};
+
+/*!
+ * \brief Writes the grid into file. The file is written under a temporary name
+ * and renamed at the end, thus an existing file is only replaced by a complete one.
+ * \param file The path to the file.
+ * \param grid The grid to be saved.
+ * \param info The non grid state to be saved.
+ * \return True on success.
+ */
+[[nodiscard]] bool save(const std::string& file, const CellGrid& grid, const WorldInfo& info);
+
+/*!
+ * \brief Compares both grids block by block.
+ * \param grid The current state.
+ * \param reference The state of the last checkpoint, must have the same number of cells.
+ * \param block_cells The number of cells per block.
+ * \return The indices of all blocks which differ in at least one value of one field.
+ */
+std::vector<uint64_t> getChangedBlocks(const CellGrid& grid,
+                                       const CellGrid& reference,
+                                       uint64_t block_cells = DELTA_BLOCK_CELLS);
+
+/*!
+ * \brief Writes only the given blocks of the grid into file, see getChangedBlocks().
+ * Like save() the file is renamed into place once it is complete.
+ * \param file The path to the file. Must differ from every file of the parent chain.
+ * \param grid The grid to be saved.
+ * \param changed_blocks The blocks which differ from the grid saved in parent_file.
+ * \param parent_file The path to the checkpoint this delta is based on.
+ * \param parent_tick The tick saved in parent_file, checked on load.
+ * \param info The non grid state to be saved.
+ * \param block_cells The number of cells per block used for changed_blocks.
+ * \return True on success.
+ */
+[[nodiscard]] bool saveDelta(const std::string& file,
+                             const CellGrid& grid,
+                             const std::vector<uint64_t>& changed_blocks,
+                             const std::string& parent_file,
+                             uint64_t parent_tick,
+                             const WorldInfo& info,
+                             uint64_t block_cells = DELTA_BLOCK_CELLS);
+
+/*!
+ * \brief Memory maps the file and lets the grid use the mapped GRID chunk as storage.
+ * Changes of the grid are private (copy on write) and never reach the file.
+ * A delta file loads its keyframe that way and copies the changed blocks of the
+ * keyframe and all following deltas into it. The cost is bounded by the chain length.
+ * \param file The path to the file.
+ * \param grid The grid to be loaded into. Unchanged on failure.
+ * \param info The non grid state to be loaded into. Unchanged on failure.
+ * \return True on success.
+ */
+[[nodiscard]] bool load(const std::string& file, CellGrid& grid, WorldInfo& info);
+}  // namespace world_file
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef WORLD_SNAPSHOT
+#define WORLD_SNAPSHOT
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "layer.h"
+
+/*!
+ * \brief The part of the world state the renderer needs, copied at the end of an update.
+ * Values are stored as float since that is what is uploaded to the GPU anyway.
+ */
+struct WorldSnapshot {
+  // number of World::update() calls which lead to this state
+  uint64_t tick = 0;
+  // [s] simulated time of this state
+  double simulation_time = 0.;
+  // when the state was published, used to interpolate between two snapshots
+  std::chrono::steady_clock::time_point wall_time;
+  // World internal: the update() which wrote the buffer, tiles which did not change since are
+  // not copied again when the buffer is reused
+  uint64_t update_count = 0;
+  std::vector<float> height[NUM_LAYER_TYPES];
+  std::vector<float> temperature[NUM_LAYER_TYPES];
+};
+
+#endif